@@ -0,0 +1,143 @@
+#pragma once
+
+#include "component.hpp"
+#include "entity.hpp"
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Type-erased column of one component type inside an archetype
+class i_column {
+  public:
+    virtual ~i_column() = default;
+    // Append a default constructed component
+    virtual void push_default() = 0;
+    // Append the component at row of a column of the same type, moving it out
+    virtual void push_moved_from(i_column &source, std::size_t row) = 0;
+    // Remove a row by moving the last row into its place
+    virtual void swap_remove(std::size_t row) = 0;
+};
+
+template <typename T> class column : public i_column {
+  public:
+    void push_default() override { data.emplace_back(); }
+
+    void push_moved_from(i_column &source, std::size_t row) override {
+        data.push_back(std::move(static_cast<column<T> &>(source).data[row]));
+    }
+
+    void swap_remove(std::size_t row) override {
+        if (row + 1 != data.size()) {
+            data[row] = std::move(data.back());
+        }
+        data.pop_back();
+    }
+
+    // Components stored contiguously, one per archetype row
+    std::vector<T> data;
+};
+
+// All entities sharing one signature, stored column by column (SoA)
+struct archetype {
+    signature archetype_signature;
+    // Row -> entity
+    std::vector<entity> entities;
+    // One column per component type in the signature, indexed by component type
+    std::array<std::unique_ptr<i_column>, MAX_COMPONENTS> columns;
+};
+
+/*
+ * Component storage that packs entities with the same signature together.
+ *
+ * Adding or removing a component moves the entity's row to the archetype of
+ * its new signature, so references to an entity's components are invalidated
+ * when its signature changes, and references to components of other entities
+ * in the destination archetype may be invalidated by the append.
+ */
+class archetype_storage {
+  public:
+    using column_factory = std::unique_ptr<i_column> (*)();
+
+    // Register how to create a column for a component type
+    template <typename T> void register_column(component_type type);
+
+    template <typename T> void insert(entity ent, component_type type, T component);
+    void remove(entity ent, component_type type);
+    template <typename T> T &get(entity ent, component_type type);
+    bool has(entity ent, component_type type) const;
+    void entity_destroyed(entity ent);
+
+    // Move an entity straight to the archetype of its final signature, with
+    // default constructed components to be overwritten through get()
+    void prepare(entity ent, signature final_signature) { move_entity(ent, final_signature); }
+
+    // Packed component column of an archetype, or null if it has no such column
+    template <typename T> T *column_data(archetype &arch, component_type type);
+    std::vector<archetype> &archetypes() { return m_archetypes; }
+
+  private:
+    static constexpr std::uint32_t NO_ARCHETYPE = std::numeric_limits<std::uint32_t>::max();
+
+    struct entity_location {
+        std::uint32_t archetype_index = NO_ARCHETYPE;
+        std::uint32_t row = 0;
+    };
+
+    // Whether a live handle currently has a row in some archetype
+    bool located(entity ent) const;
+    // Find or create the archetype for a signature
+    std::uint32_t archetype_for(signature archetype_signature);
+    // Move an entity's row to the archetype of a new signature
+    void move_entity(entity ent, signature new_signature);
+    // Drop an entity's row from its archetype, without touching other archetypes
+    void remove_row(entity ent);
+
+    // Entity index -> archetype and row
+    std::vector<entity_location> m_locations;
+    std::vector<archetype> m_archetypes;
+    std::unordered_map<signature, std::uint32_t> m_archetype_lookup;
+    std::array<column_factory, MAX_COMPONENTS> m_factories{};
+};
+
+// Template function definitions
+template <typename T> void archetype_storage::register_column(component_type type) {
+    m_factories[type] = []() -> std::unique_ptr<i_column> {
+        return std::make_unique<column<T>>();
+    };
+}
+
+template <typename T>
+void archetype_storage::insert(entity ent, component_type type, T component) {
+    assert(!has(ent, type) && "Component added to same entity more than once.");
+
+    signature new_signature;
+    if (located(ent)) {
+        new_signature = m_archetypes[m_locations[entity_index(ent)].archetype_index].archetype_signature;
+    }
+    new_signature.set(type, true);
+    move_entity(ent, new_signature);
+
+    // The new column slot was default constructed by the move
+    get<T>(ent, type) = std::move(component);
+}
+
+template <typename T> T &archetype_storage::get(entity ent, component_type type) {
+    assert(has(ent, type) && "Retrieving non-existent component.");
+
+    const entity_location &location = m_locations[entity_index(ent)];
+    archetype &arch = m_archetypes[location.archetype_index];
+    return static_cast<column<T> &>(*arch.columns[type]).data[location.row];
+}
+
+template <typename T> T *archetype_storage::column_data(archetype &arch, component_type type) {
+    if (!arch.columns[type]) {
+        return nullptr;
+    }
+    return static_cast<column<T> &>(*arch.columns[type]).data.data();
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Bit-level packet writer/reader.
+ *
+ * Values are packed least significant bit first with no padding between
+ * them, so a field takes exactly the bits its range needs. The stream is
+ * padded to a whole byte when the writer is flushed.
+ */
+class BitWriter {
+  public:
+    // Append to the end of buffer (e.g. after a packet header)
+    explicit BitWriter(std::vector<uint8_t> &buffer) : m_buffer(buffer) {}
+
+    // Write the low count bits of value (count <= 32)
+    void WriteBits(uint32_t value, unsigned count);
+    void WriteBool(bool value) { WriteBits(value ? 1 : 0, 1); }
+    // Write a two's complement value that fits in count bits
+    void WriteSigned(int32_t value, unsigned count);
+    void WriteFloat(float value);
+    void WriteBytes(const uint8_t *data, size_t size);
+    // Write out the last partial byte, padded with zero bits
+    void Flush();
+
+  private:
+    std::vector<uint8_t> &m_buffer;
+    uint64_t m_scratch = 0;
+    unsigned m_scratchBits = 0;
+};
+
+class BitReader {
+  public:
+    BitReader(const uint8_t *data, size_t size) : m_data(data), m_size(size) {}
+
+    // Read count bits (count <= 32). Reading past the end yields zeros and
+    // marks the reader as overflowed
+    uint32_t ReadBits(unsigned count);
+    bool ReadBool() { return ReadBits(1) != 0; }
+    int32_t ReadSigned(unsigned count);
+    float ReadFloat();
+    // Returns false (reading nothing) if fewer than size bytes are left
+    bool ReadBytes(uint8_t *out, size_t size);
+
+    // True once a read ran past the end of the data
+    bool HasOverflowed() const { return m_overflowed; }
+
+  private:
+    const uint8_t *m_data;
+    size_t m_size;
+    size_t m_bitPosition = 0;
+    bool m_overflowed = false;
+};
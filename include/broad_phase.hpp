@@ -0,0 +1,31 @@
+#pragma once
+
+#include "collision_layers.hpp"
+#include "entity.hpp"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+using entity_pair = std::pair<entity, entity>;
+
+/*
+ * Collision broad-phase: finds the pairs of boxes that may collide so the
+ * narrow-phase doesn't have to test every pair.
+ *
+ * Each frame the collision system calls begin_frame(), inserts the box of
+ * every active collidable entity in a fixed order, and then collect_pairs().
+ */
+class broad_phase {
+  public:
+    virtual ~broad_phase() = default;
+
+    virtual void begin_frame() = 0;
+    // Add an entity's axis-aligned box for this frame, on the given
+    // collision layers and colliding with the layers in mask
+    virtual void insert(entity ent, float x, float y, float width, float height, bool moved, std::uint32_t layer,
+                        std::uint32_t mask) = 0;
+    // Every pair of overlapping boxes where at least one moved and whose
+    // layers interact, each reported once as (earlier inserted, later
+    // inserted) in insertion order
+    virtual void collect_pairs(std::vector<entity_pair> &pairs) = 0;
+};
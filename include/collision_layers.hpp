@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+ * Collision layers and masks.
+ *
+ * A body is on one or more layers and collides with bodies on the layers in
+ * its mask. A pair is only tested when each body accepts the other, so a
+ * category of pairs (e.g. item-vs-item) is skipped by leaving a layer out of
+ * one side's mask.
+ */
+constexpr std::uint32_t LAYER_DEFAULT = 1u << 0;
+constexpr std::uint32_t LAYER_WORLD = 1u << 1;
+constexpr std::uint32_t LAYER_PLAYER = 1u << 2;
+constexpr std::uint32_t LAYER_ITEM = 1u << 3;
+constexpr std::uint32_t LAYER_ALL = 0xFFFFFFFF;
+
+// Whether two bodies' layers and masks let them collide
+inline bool layers_interact(std::uint32_t layer1, std::uint32_t mask1, std::uint32_t layer2, std::uint32_t mask2) {
+    return (layer1 & mask2) != 0 && (layer2 & mask1) != 0;
+}
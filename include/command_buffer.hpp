@@ -0,0 +1,71 @@
+#pragma once
+
+#include "entity.hpp"
+#include "entity_builder.hpp"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+class conductor;
+
+/*
+ * Records structural changes (create/destroy entities, add/remove
+ * components) so they can be made at a defined sync point instead of in the
+ * middle of a system's update, while packed storage and system entity lists
+ * are being iterated.
+ *
+ * Commands are played back in the order they were recorded. Playback is
+ * forgiving so recorders need no defensive checks: commands on entities that
+ * died in the meantime are dropped, adding a component the entity already
+ * has overwrites it, and removing a missing component does nothing.
+ *
+ * Recording is thread-safe, so systems running concurrently under the
+ * scheduler can share one buffer. Flushing is not.
+ */
+class command_buffer {
+  public:
+    // Spawn an entity from a builder, optionally reporting its handle once made
+    void create_entity(entity_builder builder, std::function<void(entity)> on_created = {});
+    void destroy_entity(entity ent);
+    template <typename T> void add_component(entity ent, T component);
+    template <typename T> void remove_component(entity ent);
+
+    // Play back every recorded command (including ones recorded during playback)
+    void flush(conductor &world);
+
+  private:
+    using command = std::function<void(conductor &)>;
+
+    void record(command recorded);
+
+    std::vector<command> m_commands;
+    // Guards m_commands while recording
+    std::mutex m_mutex;
+};
+
+// Template function definitions
+// The commands take the world as auto& so their bodies are only compiled
+// once conductor is a complete type.
+template <typename T> void command_buffer::add_component(entity ent, T component) {
+    record([ent, component = std::move(component)](auto &world) {
+        if (!world.is_alive(ent)) {
+            return;
+        }
+        if (world.template has_component<T>(ent)) {
+            world.template get_component<T>(ent) = component;
+        } else {
+            world.template add_component<T>(ent, component);
+        }
+    });
+}
+
+template <typename T> void command_buffer::remove_component(entity ent) {
+    record([ent](auto &world) {
+        if (world.is_alive(ent) && world.template has_component<T>(ent)) {
+            world.template remove_component<T>(ent);
+        }
+    });
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "bit_stream.hpp"
+#include <cstdint>
+
+struct transform;
+struct rigidbody;
+
+/*
+ * Quantized delta encoding of the components that change every frame.
+ *
+ * A component is reduced to the quantized fields sent over the network:
+ * positions and velocities as fixed point, the rest as-is. An update starts
+ * with one dirty bit per field group and carries only the groups that differ
+ * from a baseline (the state last sent for the entity), so a body moving
+ * along one axis costs a few bytes. The receiver applies the groups it gets
+ * on top of its own copy of the component.
+ */
+
+// Fixed point steps per pixel for positions, and bits per position axis
+// (about +-2 million pixels)
+constexpr float NET_POSITION_SCALE = 16.0f;
+constexpr unsigned NET_POSITION_BITS = 26;
+// Fixed point steps per pixel per second for velocities, clamped to
+// +-MAX_NET_VELOCITY
+constexpr float NET_VELOCITY_SCALE = 16.0f;
+constexpr float MAX_NET_VELOCITY = 4096.0f;
+constexpr unsigned NET_VELOCITY_BITS = 18;
+
+// Field groups of a transform update
+constexpr uint32_t TRANSFORM_DIRTY_POSITION_X = 1u << 0;
+constexpr uint32_t TRANSFORM_DIRTY_POSITION_Y = 1u << 1;
+constexpr uint32_t TRANSFORM_DIRTY_SCALE = 1u << 2;
+constexpr unsigned TRANSFORM_DIRTY_BITS = 3;
+
+// Field groups of a rigidbody update
+constexpr uint32_t RIGIDBODY_DIRTY_VELOCITY_X = 1u << 0;
+constexpr uint32_t RIGIDBODY_DIRTY_VELOCITY_Y = 1u << 1;
+constexpr uint32_t RIGIDBODY_DIRTY_PROPERTIES = 1u << 2;
+constexpr unsigned RIGIDBODY_DIRTY_BITS = 3;
+
+struct QuantizedTransform {
+    int32_t position[2];
+    float scale[2];
+};
+
+struct QuantizedRigidbody {
+    int32_t velocity[2];
+    // Rarely changing properties, sent as one group
+    float mass;
+    float base_size[2];
+    uint32_t layer;
+    uint32_t mask;
+    bool can_collide;
+    bool is_static;
+    bool is_trigger;
+};
+
+QuantizedTransform QuantizeTransform(const transform &trans);
+QuantizedRigidbody QuantizeRigidbody(const rigidbody &rb);
+
+// Field groups of current that differ from baseline (all of them without one)
+uint32_t TransformDirtyFields(const QuantizedTransform &current, const QuantizedTransform *baseline);
+uint32_t RigidbodyDirtyFields(const QuantizedRigidbody &current, const QuantizedRigidbody *baseline);
+
+// Write the dirty bits followed by the dirty field groups
+void WriteTransformDelta(BitWriter &writer, const QuantizedTransform &current, uint32_t dirty);
+void WriteRigidbodyDelta(BitWriter &writer, const QuantizedRigidbody &current, uint32_t dirty);
+
+// Copy the dirty field groups of current into baseline (e.g. once the
+// update carrying them is acknowledged)
+void ApplyTransformFields(QuantizedTransform &baseline, const QuantizedTransform &current, uint32_t dirty);
+void ApplyRigidbodyFields(QuantizedRigidbody &baseline, const QuantizedRigidbody &current, uint32_t dirty);
+
+// Apply an update written above onto a component. A transform's
+// last_position becomes its position before the update
+void ReadTransformDelta(BitReader &reader, transform &trans);
+// Returns whether the velocity changed
+bool ReadRigidbodyDelta(BitReader &reader, rigidbody &rb);
@@ -1,51 +1,87 @@
+#include <array>
 #include <memory>
-#include <unordered_map>
 #include <cassert>
-#include <typeinfo>
+#include <limits>
 #include "component.hpp"
 #include "i_component_array.hpp"
+#include "component_view.hpp"
+#include "archetype_storage.hpp"
 
 #ifndef COMPONENT_MANAGER_H
 #define COMPONENT_MANAGER_H
 
+// How component data is laid out in memory
+enum class storage_mode
+{
+	// One packed array per component type (default)
+	sparse_set,
+	// Entities with the same signature packed together column by column
+	archetype
+};
+
 class component_manager
 {
 public:
+	explicit component_manager(storage_mode mode = storage_mode::sparse_set);
+	storage_mode get_storage_mode() const { return mode; }
 	template<typename T> void register_component();
 	template<typename T> component_type get_component_type();
 	template<typename T> void add_component(entity entity, T component);
 	template<typename T> void remove_component(entity entity);
 	template<typename T> T& get_component(entity entity);
 	template<typename T> bool has_component(entity entity);
+	template<typename... Ts> component_view<Ts...> view();
+	// Reserve storage for a fresh entity's complete signature in one step
+	void prepare_entity(entity entity, signature entity_signature);
+	// Add a component to an entity whose storage was set up by prepare_entity
+	template<typename T> void place_component(entity entity, T component);
 	void entity_destroyed(entity entity);
 private:
-	// Map from type string pointer to a component type
-	std::unordered_map<const char*, component_type> component_types{};
+	// Value of a type slot whose component has not been registered yet
+	static constexpr component_type UNREGISTERED = std::numeric_limits<component_type>::max();
+
+	// Per-type slot holding the component type assigned at registration.
+	// Every T gets its own static, so looking up a type is a single load with no hashing
+	template<typename T>
+	static inline component_type type_slot = UNREGISTERED;
+
+	// Storage layout selected at construction
+	storage_mode mode;
 
-	// Map from type string pointer to a component array
-	std::unordered_map<const char*, std::shared_ptr<i_component_array>> component_arrays{};
+	// Component arrays indexed by component type (sparse_set mode)
+	std::array<std::unique_ptr<i_component_array>, MAX_COMPONENTS> component_arrays{};
+
+	// Signature-grouped component columns (archetype mode)
+	archetype_storage archetypes;
 
 	// The component type to be assigned to the next registered component - starting at 0
 	component_type next_component_type{};
 
-	// Convenience function to get the statically casted pointer to the ComponentArray of type T.
+	// Convenience function to get the statically casted ComponentArray of type T.
 	template<typename T>
-	std::shared_ptr<component_array<T>> get_component_array();
+	component_array<T>& get_component_array();
 };
 
 // Template function definitions
 template<typename T>
 void component_manager::register_component()
 {
-    const char* typeName = typeid(T).name();
-
-    assert(component_types.find(typeName) == component_types.end() && "Registering component type more than once.");
-
-    // Add this component type to the component type map
-    component_types.insert({typeName, next_component_type});
-
-    // Create a ComponentArray pointer and add it to the component arrays map
-    component_arrays.insert({typeName, std::make_shared<component_array<T>>()});
+    assert(type_slot<T> == UNREGISTERED && "Registering component type more than once.");
+    assert(next_component_type < MAX_COMPONENTS && "Too many component types registered.");
+
+    // Assign this component type to the type's slot
+    type_slot<T> = next_component_type;
+
+    if (mode == storage_mode::archetype)
+    {
+        // Archetypes create their columns on demand
+        archetypes.register_column<T>(next_component_type);
+    }
+    else
+    {
+        // Create a ComponentArray and store it at the component type's index
+        component_arrays[next_component_type] = std::make_unique<component_array<T>>();
+    }
 
     // Increment the value so that the next component registered will be different
     ++next_component_type;
@@ -54,51 +90,107 @@ void component_manager::register_component()
 template<typename T>
 component_type component_manager::get_component_type()
 {
-    const char* typeName = typeid(T).name();
-
-    assert(component_types.find(typeName) != component_types.end() && "Component not registered before use.");
+    assert(type_slot<T> != UNREGISTERED && "Component not registered before use.");
 
     // Return this component's type - used for creating signatures
-    return component_types[typeName];
+    return type_slot<T>;
 }
 
 template<typename T>
 void component_manager::add_component(entity entity, T component)
 {
+    if (mode == storage_mode::archetype)
+    {
+        archetypes.insert<T>(entity, get_component_type<T>(), std::move(component));
+        return;
+    }
+
     // Add a component to the array for an entity
-    get_component_array<T>()->insert_data(entity, component);
+    get_component_array<T>().insert_data(entity, component);
+}
+
+template<typename T>
+void component_manager::place_component(entity entity, T component)
+{
+    if (mode == storage_mode::archetype)
+    {
+        // The entity already sits in its final archetype, so only the slot is written
+        archetypes.get<T>(entity, get_component_type<T>()) = std::move(component);
+        return;
+    }
+
+    get_component_array<T>().insert_data(entity, std::move(component));
 }
 
 template<typename T>
 void component_manager::remove_component(entity entity)
 {
+    if (mode == storage_mode::archetype)
+    {
+        archetypes.remove(entity, get_component_type<T>());
+        return;
+    }
+
     // Remove a component from the array for an entity
-    get_component_array<T>()->remove_data(entity);
+    get_component_array<T>().remove_data(entity);
 }
 
 template<typename T>
 T& component_manager::get_component(entity entity)
 {
+    if (mode == storage_mode::archetype)
+    {
+        return archetypes.get<T>(entity, get_component_type<T>());
+    }
+
     // Get a reference to a component from the array for an entity
-    return get_component_array<T>()->get_data(entity);
+    return get_component_array<T>().get_data(entity);
 }
 
 template<typename T>
 bool component_manager::has_component(entity entity)
 {
+    if (mode == storage_mode::archetype)
+    {
+        return archetypes.has(entity, get_component_type<T>());
+    }
+
     // Check if an entity has a component
-    return get_component_array<T>()->has_data(entity);
+    return get_component_array<T>().has_data(entity);
 }
 
-// Convenience function to get the statically casted pointer to the ComponentArray of type T.
-template<typename T>
-std::shared_ptr<component_array<T>> component_manager::get_component_array()
+template<typename... Ts>
+component_view<Ts...> component_manager::view()
 {
-    const char* type_name = typeid(T).name();
+    if (mode == storage_mode::archetype)
+    {
+        signature required;
+        (required.set(get_component_type<Ts>(), true), ...);
+
+        // One chunk per non-empty archetype containing every requested component
+        std::vector<typename component_view<Ts...>::chunk> chunks;
+        for (archetype& arch : archetypes.archetypes())
+        {
+            if (arch.entities.empty() || (arch.archetype_signature & required) != required)
+                continue;
+
+            chunks.push_back({arch.entities.data(), arch.entities.size(),
+                              std::make_tuple(archetypes.column_data<Ts>(arch, get_component_type<Ts>())...)});
+        }
+        return component_view<Ts...>(std::move(chunks));
+    }
+
+    // Query every entity that owns all of the given components
+    return component_view<Ts...>(get_component_array<Ts>()...);
+}
 
-    assert(component_types.find(type_name) != component_types.end() && "Component not registered before use.");
+// Convenience function to get the statically casted ComponentArray of type T.
+template<typename T>
+component_array<T>& component_manager::get_component_array()
+{
+    assert(type_slot<T> != UNREGISTERED && "Component not registered before use.");
 
-    return std::static_pointer_cast<component_array<T>>(component_arrays[type_name]);
+    return static_cast<component_array<T>&>(*component_arrays[type_slot<T>]);
 }
 
 #endif
\ No newline at end of file
@@ -21,6 +21,9 @@ enum class ComponentID : uint8_t {
     // Add more as needed
 };
 
+// Bits a ComponentID takes in bit-packed component updates
+constexpr unsigned COMPONENT_ID_BITS = 4;
+
 // Serialization result
 struct SerializedComponent {
     ComponentID id;
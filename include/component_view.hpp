@@ -0,0 +1,168 @@
+#pragma once
+
+#include "entity.hpp"
+#include "i_component_array.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/*
+ * A query over every entity that owns all of the component types Ts.
+ *
+ * Iteration yields std::tuple<entity, Ts&...>, so a system can write
+ *
+ *   for (auto [ent, trans, rb] : g_conductor.view<transform, rigidbody>())
+ *
+ * The view walks a list of chunks. With sparse-set storage there is a single
+ * chunk: the packed entity list of the smallest component array involved,
+ * with the other components looked up per entity. With archetype storage
+ * there is one chunk per matching archetype, whose component columns are
+ * streamed directly.
+ *
+ * Entities must not gain or lose any components while a view is being
+ * iterated, as that reorders the packed storage underneath it.
+ */
+template <typename... Ts> class component_view {
+    static_assert(sizeof...(Ts) > 0, "A view needs at least one component type.");
+
+  public:
+    using value_type = std::tuple<entity, Ts &...>;
+
+    // A run of entities with their component columns
+    struct chunk {
+        const entity *entities;
+        std::size_t count;
+        // Packed columns indexed by row, or null to look components up by entity
+        std::tuple<Ts *...> columns;
+    };
+
+    class iterator {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = component_view::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = value_type;
+
+        iterator(const component_view *view, std::size_t chunk_index)
+            : m_view(view), m_chunk(chunk_index), m_row(0) {
+            skip_unmatched();
+        }
+
+        reference operator*() const {
+            const chunk &current = m_view->m_chunks[m_chunk];
+            entity ent = current.entities[m_row];
+            return value_type(ent, m_view->template fetch<Ts>(current, m_row, ent)...);
+        }
+
+        iterator &operator++() {
+            ++m_row;
+            skip_unmatched();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator previous = *this;
+            ++(*this);
+            return previous;
+        }
+
+        bool operator==(const iterator &other) const {
+            return m_chunk == other.m_chunk && m_row == other.m_row;
+        }
+        bool operator!=(const iterator &other) const { return !(*this == other); }
+
+      private:
+        // Advance to the next row that owns every viewed component
+        void skip_unmatched() {
+            while (m_chunk < m_view->m_chunks.size()) {
+                const chunk &current = m_view->m_chunks[m_chunk];
+                if (m_row >= current.count) {
+                    ++m_chunk;
+                    m_row = 0;
+                    continue;
+                }
+                if (!m_view->m_filtered || m_view->contains(current.entities[m_row])) {
+                    return;
+                }
+                ++m_row;
+            }
+        }
+
+        const component_view *m_view;
+        std::size_t m_chunk;
+        std::size_t m_row;
+    };
+
+    // Sparse-set storage: drive iteration from the smallest component array
+    explicit component_view(component_array<Ts> &...arrays)
+        : m_arrays(&arrays...), m_filtered(true) {
+        const std::vector<entity> *driver = nullptr;
+        ((driver == nullptr || arrays.entities().size() < driver->size()
+              ? driver = &arrays.entities()
+              : driver),
+         ...);
+        m_chunks.push_back(chunk{driver->data(), driver->size(), std::tuple<Ts *...>()});
+    }
+
+    // Archetype storage: every chunk already owns all viewed components
+    explicit component_view(std::vector<chunk> chunks)
+        : m_arrays(), m_chunks(std::move(chunks)), m_filtered(false) {}
+
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, m_chunks.size()); }
+
+    // Upper bound on the number of entities the view will yield
+    std::size_t size_hint() const {
+        std::size_t total = 0;
+        for (const chunk &current : m_chunks) {
+            total += current.count;
+        }
+        return total;
+    }
+
+    // Call fn(entity, Ts&...) for the rows at positions [begin, end) of the
+    // chunks laid end to end (the positions counted by size_hint()), skipping
+    // rows without every viewed component. Disjoint ranges touch disjoint
+    // entities, so they may be visited from different threads
+    template <typename Fn> void for_each_in(std::size_t begin, std::size_t end, Fn &&fn) const {
+        std::size_t offset = 0;
+        for (const chunk &current : m_chunks) {
+            std::size_t first = std::max(begin, offset);
+            std::size_t last = std::min(end, offset + current.count);
+            for (std::size_t position = first; position < last; ++position) {
+                std::size_t row = position - offset;
+                entity ent = current.entities[row];
+                if (!m_filtered || contains(ent)) {
+                    fn(ent, fetch<Ts>(current, row, ent)...);
+                }
+            }
+            offset += current.count;
+            if (offset >= end) {
+                break;
+            }
+        }
+    }
+
+  private:
+    // Check whether an entity owns every viewed component (sparse-set storage)
+    bool contains(entity ent) const {
+        return (std::get<component_array<Ts> *>(m_arrays)->has_data(ent) && ...);
+    }
+
+    template <typename T> T &fetch(const chunk &current, std::size_t row, entity ent) const {
+        T *packed = std::get<T *>(current.columns);
+        if (packed != nullptr) {
+            return packed[row];
+        }
+        return std::get<component_array<T> *>(m_arrays)->get_data(ent);
+    }
+
+    std::tuple<component_array<Ts> *...> m_arrays;
+    std::vector<chunk> m_chunks;
+    // True when chunk rows still need checking against the other arrays
+    bool m_filtered;
+};
@@ -1,15 +1,43 @@
 #ifndef RIGIDBODY_HPP
 #define RIGIDBODY_HPP
 
+#include "collision_layers.hpp"
 #include <SFML/Graphics/RectangleShape.hpp>
+#include <cstdint>
+
+// Axis-aligned box in world space
+struct aabb
+{
+    float position[2]; // Top-left corner
+    float size[2];
+};
+
+// Sleep island of a body that isn't sleeping
+constexpr std::uint32_t NO_SLEEP_ISLAND = 0xFFFFFFFF;
 
 struct rigidbody
 {
     float velocity[2];
     float Mass;
-    sf::RectangleShape Hitbox;
+    sf::RectangleShape Hitbox; // Only rebuilt from bounds for debug drawing
     bool can_collide;
     float base_size[2]; // Base dimensions of the hitbox (before scaling)
+    bool is_static = false; // Never moves (level geometry), collides through the static tree
+    aabb bounds{}; // Collision bounds from transform and base_size, kept current by collision_detection_system
+    bool is_sleeping = false; // At rest - skipped by physics and collision until woken
+    std::uint16_t still_frames = 0; // Consecutive collision updates spent (nearly) at rest
+    std::uint32_t sleep_island = NO_SLEEP_ISLAND; // Bodies resting on each other sleep and wake together
+    std::uint32_t layer = LAYER_DEFAULT; // Collision layers the body is on
+    std::uint32_t mask = LAYER_ALL; // Collision layers the body collides with
+    bool is_trigger = false; // Reports contacts without being separated from other bodies
 };
 
-#endif
\ No newline at end of file
+// Wake a sleeping body, e.g. before moving it from outside the simulation.
+// The rest of its island is woken by the next collision update
+inline void wake(rigidbody &body)
+{
+    body.is_sleeping = false;
+    body.still_frames = 0;
+}
+
+#endif
@@ -1,27 +1,53 @@
 #pragma once
 
+#include "command_buffer.hpp"
 #include "component_manager.hpp"
 #include "entity.hpp"
+#include "entity_builder.hpp"
 #include "entity_manager.hpp"
 #include "system_manager.hpp"
+#include <cstddef>
 #include <memory>
+#include <vector>
 
 class conductor {
 public:
-  void init();
+  void init(storage_mode mode = storage_mode::sparse_set,
+            entity initial_capacity = DEFAULT_ENTITY_CAPACITY);
   entity create_entity();
+  // Spawn an entity with every staged component, updating systems once
+  entity create_entity(const entity_builder &builder);
+  // Spawn count copies of a prototype, updating systems once for the batch
+  std::vector<entity> create_entities(std::size_t count,
+                                      const entity_builder &prototype);
   void destroy_entity(entity entity);
+  void destroy_entities(const std::vector<entity> &entities);
+  // Whether a handle still refers to a living entity (false once destroyed)
+  bool is_alive(entity entity) const;
+  // Components an entity has, one bit per component type
+  signature get_signature(entity entity) const;
   entity create_networked_entity(uint32_t network_id, bool is_local);
+  entity create_networked_entity(uint32_t network_id, bool is_local,
+                                 entity_builder builder);
   template <typename T> void register_component();
   template <typename T> void add_component(entity entity, T component);
   template <typename T> void remove_component(entity entity);
   template <typename T> T &get_component(entity entity);
   template <typename T> bool has_component(entity entity);
+  template <typename... Ts> component_view<Ts...> view();
   template <typename T> component_type get_component_type();
+  // Signature with the bits of every given component type set
+  template <typename... Ts> signature make_signature();
   template <typename T> std::shared_ptr<T> register_system();
   template <typename T> void set_system_signature(signature signature);
 
+  // Structural changes recorded during system updates, applied by
+  // flush_commands() at the frame's sync point
+  command_buffer &commands() { return m_commands; }
+  void flush_commands() { m_commands.flush(*this); }
+
 private:
+  command_buffer m_commands;
   std::unique_ptr<component_manager> m_component_manager;
   std::unique_ptr<entity_manager> m_entity_manager;
   std::unique_ptr<system_manager> m_system_manager;
@@ -61,10 +87,20 @@ template <typename T> bool conductor::has_component(entity entity) {
   return m_component_manager->has_component<T>(entity);
 }
 
+template <typename... Ts> component_view<Ts...> conductor::view() {
+  return m_component_manager->view<Ts...>();
+}
+
 template <typename T> component_type conductor::get_component_type() {
   return m_component_manager->get_component_type<T>();
 }
 
+template <typename... Ts> signature conductor::make_signature() {
+  signature result;
+  (result.set(m_component_manager->get_component_type<Ts>(), true), ...);
+  return result;
+}
+
 template <typename T> std::shared_ptr<T> conductor::register_system() {
   return m_system_manager->register_system<T>();
 }
@@ -1,6 +1,27 @@
 #pragma once
 
 #include <cstdint>
-// Entity is merely an ID (unique)
+#include <limits>
+// Entity is merely an ID (unique). The low ENTITY_INDEX_BITS are the index
+// used by all storage; the high bits are a generation counter that is bumped
+// every time the index is recycled, so stale handles can be detected.
 using entity = std::uint32_t;
-constexpr entity MAX_ENTITIES = 10000;
\ No newline at end of file
+
+constexpr unsigned ENTITY_INDEX_BITS = 24;
+constexpr entity ENTITY_INDEX_MASK = (entity(1) << ENTITY_INDEX_BITS) - 1;
+constexpr entity ENTITY_GENERATION_MASK = ~ENTITY_INDEX_MASK;
+
+// Handle that never refers to a living entity
+constexpr entity NULL_ENTITY = std::numeric_limits<entity>::max();
+// Hard limit on simultaneously living entities (the last index is reserved for NULL_ENTITY)
+constexpr entity MAX_ENTITIES = ENTITY_INDEX_MASK;
+// Number of entities storage is sized for up front; it grows past this on demand
+constexpr entity DEFAULT_ENTITY_CAPACITY = 10000;
+
+// Storage index of an entity handle
+constexpr entity entity_index(entity ent) { return ent & ENTITY_INDEX_MASK; }
+// How many times the handle's index had been recycled when it was created
+constexpr entity entity_generation(entity ent) { return ent >> ENTITY_INDEX_BITS; }
+constexpr entity make_entity(entity index, entity generation) {
+  return (generation << ENTITY_INDEX_BITS) | (index & ENTITY_INDEX_MASK);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "component.hpp"
+#include "component_manager.hpp"
+#include "entity.hpp"
+#include <cassert>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/*
+ * Staged set of components for spawning an entity in one step.
+ *
+ *   entity_builder coin;
+ *   coin.with(transform{...}).with(rigidbody{...}).with(entity_state{true, false});
+ *   g_conductor.create_entities(100, coin);
+ *
+ * The conductor computes the final signature once, places the entity's
+ * storage for that signature, and updates system membership a single time
+ * instead of once per added component. A builder can be reused as a
+ * prototype: every entity created from it receives a copy of each component.
+ */
+class entity_builder {
+  public:
+    entity_builder() = default;
+    entity_builder(entity_builder &&) = default;
+    entity_builder &operator=(entity_builder &&) = default;
+    entity_builder(const entity_builder &) = delete;
+    entity_builder &operator=(const entity_builder &) = delete;
+
+    // Stage a component, each type at most once
+    template <typename T> entity_builder &with(T component) {
+        assert(!has<T>() && "Component staged on same builder more than once.");
+        m_components.push_back(std::make_unique<staged<T>>(std::move(component)));
+        return *this;
+    }
+
+    template <typename T> bool has() const {
+        for (const auto &component : m_components) {
+            if (dynamic_cast<const staged<T> *>(component.get()) != nullptr) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Signature of an entity built from the staged components
+    signature build_signature(component_manager &components) const {
+        signature result;
+        for (const auto &component : m_components) {
+            result.set(component->type(components), true);
+        }
+        return result;
+    }
+
+    // Copy every staged component onto an entity prepared for build_signature()
+    void place(component_manager &components, entity ent) const {
+        for (const auto &component : m_components) {
+            component->place(components, ent);
+        }
+    }
+
+  private:
+    // Type-erased staged component
+    struct i_staged {
+        virtual ~i_staged() = default;
+        virtual component_type type(component_manager &components) const = 0;
+        virtual void place(component_manager &components, entity ent) const = 0;
+    };
+
+    template <typename T> struct staged : i_staged {
+        explicit staged(T value) : value(std::move(value)) {}
+
+        component_type type(component_manager &components) const override {
+            return components.get_component_type<T>();
+        }
+
+        void place(component_manager &components, entity ent) const override {
+            components.place_component<T>(ent, value);
+        }
+
+        T value;
+    };
+
+    std::vector<std::unique_ptr<i_staged>> m_components;
+};
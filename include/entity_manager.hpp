@@ -1,6 +1,6 @@
-#include <array>
 #include <cstdint>
 #include <queue>
+#include <vector>
 #include "entity.hpp"
 #include "component.hpp"
 
@@ -9,21 +9,30 @@
 
 class entity_manager {
     public:
-        entity_manager();
+        explicit entity_manager(entity initial_capacity = DEFAULT_ENTITY_CAPACITY);
+        // Throws std::length_error once MAX_ENTITIES are alive
         entity create_entity();
         void destroy_entity(entity entity);
+        bool is_alive(entity entity) const;
         signature get_signature(entity entity);
         void set_signature(entity entity, signature signature);
 
     private:
-        // Queue of unused entity IDs
+        // Recycled indices are only reused once this many are queued, so a
+        // single index is not churned through its generations too quickly
+        static constexpr std::size_t MIN_FREE_INDICES = 1024;
+
+        // Queue of destroyed entity indices waiting to be reused
         std::queue<entity> available_entities{};
     
-        // Array of signatures where the index corresponds to the entity ID
-        std::array<signature, MAX_ENTITIES> signatures{};
+        // Signatures where the position corresponds to the entity index
+        std::vector<signature> signatures{};
+
+        // Current generation of each entity index
+        std::vector<entity> generations{};
     
         // Total living entities - used to keep limits on how many exist
         std::uint32_t living_entity_count{};
 };
 
-#endif
\ No newline at end of file
+#endif
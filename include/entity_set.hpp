@@ -0,0 +1,120 @@
+#pragma once
+
+#include "entity.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/*
+ * Packed set of entities used for system membership.
+ *
+ * A sparse array maps each entity ID to its position in a dense vector, so
+ * insert/erase/contains are O(1) and iteration is a linear walk over
+ * contiguous memory. Erasing swaps the last entity into the freed slot, so
+ * iteration order is unspecified unless sorted mode is enabled, in which case
+ * the dense vector is kept in ascending entity index order (at O(n)
+ * insert/erase).
+ */
+class entity_set {
+  public:
+    using const_iterator = std::vector<entity>::const_iterator;
+
+    // Insert an entity, returns false if it was already present
+    bool insert(entity ent) {
+        if (contains(ent)) {
+            return false;
+        }
+        entity index = entity_index(ent);
+        if (index >= m_sparse.size()) {
+            m_sparse.resize(static_cast<std::size_t>(index) + 1, INVALID_INDEX);
+        }
+
+        if (!m_sorted) {
+            m_sparse[index] = static_cast<std::uint32_t>(m_dense.size());
+            m_dense.push_back(ent);
+            return true;
+        }
+
+        // Sorted mode: insert in order and reindex everything after it
+        auto position = std::lower_bound(m_dense.begin(), m_dense.end(), ent, index_less);
+        std::size_t slot = static_cast<std::size_t>(position - m_dense.begin());
+        m_dense.insert(position, ent);
+        reindex_from(slot);
+        return true;
+    }
+
+    // Erase an entity, returns false if it was not present
+    bool erase(entity ent) {
+        if (!contains(ent)) {
+            return false;
+        }
+        std::uint32_t slot = m_sparse[entity_index(ent)];
+        m_sparse[entity_index(ent)] = INVALID_INDEX;
+
+        if (!m_sorted) {
+            // Move the last entity into the freed slot to keep the list packed
+            entity last = m_dense.back();
+            m_dense[slot] = last;
+            if (last != ent) {
+                m_sparse[entity_index(last)] = slot;
+            }
+            m_dense.pop_back();
+            return true;
+        }
+
+        m_dense.erase(m_dense.begin() + slot);
+        reindex_from(slot);
+        return true;
+    }
+
+    bool contains(entity ent) const {
+        entity index = entity_index(ent);
+        // A stale handle shares its index with a newer entity but not its generation
+        return index < m_sparse.size() && m_sparse[index] != INVALID_INDEX &&
+               m_dense[m_sparse[index]] == ent;
+    }
+
+    // Switch between packed (unordered) and ascending entity index order
+    void set_sorted(bool sorted) {
+        m_sorted = sorted;
+        if (m_sorted) {
+            std::sort(m_dense.begin(), m_dense.end(), index_less);
+            reindex_from(0);
+        }
+    }
+    bool is_sorted() const { return m_sorted; }
+
+    void clear() {
+        for (entity ent : m_dense) {
+            m_sparse[entity_index(ent)] = INVALID_INDEX;
+        }
+        m_dense.clear();
+    }
+
+    std::size_t size() const { return m_dense.size(); }
+    bool empty() const { return m_dense.empty(); }
+    entity operator[](std::size_t index) const { return m_dense[index]; }
+    const_iterator begin() const { return m_dense.begin(); }
+    const_iterator end() const { return m_dense.end(); }
+
+  private:
+    static constexpr std::uint32_t INVALID_INDEX = std::numeric_limits<std::uint32_t>::max();
+
+    // Order entities by index, ignoring the generation bits
+    static bool index_less(entity a, entity b) { return entity_index(a) < entity_index(b); }
+
+    // Refresh the sparse entries of every dense slot from slot onwards
+    void reindex_from(std::size_t slot) {
+        for (std::size_t i = slot; i < m_dense.size(); ++i) {
+            m_sparse[entity_index(m_dense[i])] = static_cast<std::uint32_t>(i);
+        }
+    }
+
+    // Entity index -> position in m_dense (INVALID_INDEX when absent)
+    std::vector<std::uint32_t> m_sparse;
+    // Packed member entities
+    std::vector<entity> m_dense;
+    bool m_sorted = false;
+};
@@ -1,7 +1,46 @@
 #ifndef HELP_FUNCTIONS_HPP
 #define HELP_FUNCTIONS_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 bool rectanglesIntersect(float x1, float y1, float w1, float h1,
     float x2, float y2, float w2, float h2);
 
-#endif
\ No newline at end of file
+// Whether rectangle 1, moving by (dx, dy) from where it doesn't overlap
+// rectangle 2, runs into it during the move. On a hit, time is the fraction
+// of the move at which they first touch and axis the one they meet on (0 for
+// X, 1 for Y)
+bool sweptRectanglesHit(float x1, float y1, float w1, float h1, float dx, float dy,
+    float x2, float y2, float w2, float h2, float& time, int& axis);
+
+// Rectangles packed as structure-of-arrays, so one rectangle can be tested
+// against several of them per instruction
+struct rectangle_batch {
+    std::vector<float> x, y, w, h;
+
+    void clear() {
+        x.clear();
+        y.clear();
+        w.clear();
+        h.clear();
+    }
+    void push_back(float rx, float ry, float rw, float rh) {
+        x.push_back(rx);
+        y.push_back(ry);
+        w.push_back(rw);
+        h.push_back(rh);
+    }
+    std::size_t size() const { return x.size(); }
+    bool empty() const { return x.empty(); }
+};
+
+// Same test as rectanglesIntersect against every rectangle of the batch,
+// appending the indices of the intersecting ones to hits in ascending order.
+// Uses AVX2 when built with CASINO_ROYALE_AVX2, SSE2 on other x86-64 builds
+// and scalar code elsewhere
+void rectanglesIntersectBatch(float x, float y, float w, float h,
+    const rectangle_batch& batch, std::vector<std::uint32_t>& hits);
+
+#endif
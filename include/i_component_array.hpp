@@ -4,7 +4,12 @@
 #include <array>
 #include <cassert>
 #include <cstddef>
-#include <unordered_map>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
 
 class i_component_array {
 public:
@@ -12,80 +17,162 @@ public:
   virtual void entity_destroyed(entity entity) = 0;
 };
 
+// Components per page of packed storage (a power of two)
+constexpr std::size_t COMPONENT_PAGE_SIZE = 256;
+// Entity IDs covered by one page of the sparse index (a power of two)
+constexpr std::size_t SPARSE_PAGE_SIZE = 1024;
+
 template <typename T> class component_array : public i_component_array {
 public:
+  component_array() = default;
+  component_array(const component_array &) = delete;
+  component_array &operator=(const component_array &) = delete;
+  ~component_array() override;
+
   void insert_data(entity ent, T component);
   void remove_data(entity ent);
   T &get_data(entity ent);
   bool has_data(entity ent);
   void entity_destroyed(entity ent) override;
+  // Packed list of the entities that currently own a component of type T
+  const std::vector<entity> &entities() const { return index_to_entity; }
 
 private:
+  // Marks a sparse slot whose entity has no component in this array.
+  static constexpr std::uint32_t INVALID_INDEX =
+      std::numeric_limits<std::uint32_t>::max();
+
+  // Block of the sparse index, allocated when the first entity in its range
+  // gains a component and released when the last one loses it.
+  struct sparse_page {
+    sparse_page() { index.fill(INVALID_INDEX); }
+    std::array<std::uint32_t, SPARSE_PAGE_SIZE> index;
+    std::size_t used = 0;
+  };
+
+  T *slot(std::size_t index) {
+    return m_pages[index / COMPONENT_PAGE_SIZE] + index % COMPONENT_PAGE_SIZE;
+  }
+  std::uint32_t sparse_index(entity ent) const;
+
   /*
-   * The packed array of components (of generic type T),
-   * set to a specified maximum amount, matching the maximum number
-   * of entities allowed to exist simultaneously, so that each entity
-   * has a unique spot.
+   * The packed components (of generic type T), split into fixed-size pages
+   * of raw storage. Pages are allocated as the array grows and only live
+   * components are constructed, so memory follows the number of entities
+   * owning T rather than MAX_ENTITIES. Growing never moves existing
+   * components.
    */
-  std::array<T, MAX_ENTITIES> m_component_array;
-  // Map from an entity ID to an array index.
-  std::unordered_map<entity, size_t> entity_to_index_map;
-  // Map from an array index to an entity ID.
-  std::unordered_map<size_t, entity> index_to_entity_map;
-  // Total size of valid entries in the array.
-  size_t size;
+  std::vector<T *> m_pages;
+  // Paged sparse index from an entity index to a packed index.
+  std::vector<std::unique_ptr<sparse_page>> entity_to_index;
+  // Dense list from a packed index to an entity ID, kept in step with the
+  // packed components. Its size is the number of valid entries.
+  std::vector<entity> index_to_entity;
 };
 
 // Template function definitions
+template <typename T> component_array<T>::~component_array() {
+  for (std::size_t i = 0; i < index_to_entity.size(); ++i) {
+    slot(i)->~T();
+  }
+  std::allocator<T> allocator;
+  for (T *page : m_pages) {
+    allocator.deallocate(page, COMPONENT_PAGE_SIZE);
+  }
+}
+
+template <typename T>
+std::uint32_t component_array<T>::sparse_index(entity ent) const {
+  std::size_t page = entity_index(ent) / SPARSE_PAGE_SIZE;
+  if (page >= entity_to_index.size() || !entity_to_index[page]) {
+    return INVALID_INDEX;
+  }
+  std::uint32_t index =
+      entity_to_index[page]->index[entity_index(ent) % SPARSE_PAGE_SIZE];
+  // A stale handle shares the index of a newer entity but not its generation
+  if (index == INVALID_INDEX || index_to_entity[index] != ent) {
+    return INVALID_INDEX;
+  }
+  return index;
+}
+
 template <typename T>
 void component_array<T>::insert_data(entity ent, T component) {
-  assert(entity_to_index_map.find(ent) == entity_to_index_map.end() &&
-         "Component added to same entity more than once.");
-
-  // Put new entry at end and update the maps
-  size_t new_index = size;
-  entity_to_index_map[ent] = new_index;
-  index_to_entity_map[new_index] = ent;
-  m_component_array[new_index] = component;
-  ++size;
+  assert(!has_data(ent) && "Component added to same entity more than once.");
+
+  // Make sure the entity's sparse page exists
+  std::size_t page = entity_index(ent) / SPARSE_PAGE_SIZE;
+  if (page >= entity_to_index.size()) {
+    entity_to_index.resize(page + 1);
+  }
+  if (!entity_to_index[page]) {
+    entity_to_index[page] = std::make_unique<sparse_page>();
+  }
+
+  // Put new entry at end, allocating a packed page when crossing into one
+  std::size_t new_index = index_to_entity.size();
+  if (new_index / COMPONENT_PAGE_SIZE >= m_pages.size()) {
+    m_pages.push_back(std::allocator<T>().allocate(COMPONENT_PAGE_SIZE));
+  }
+  new (slot(new_index)) T(std::move(component));
+
+  entity_to_index[page]->index[entity_index(ent) % SPARSE_PAGE_SIZE] =
+      static_cast<std::uint32_t>(new_index);
+  ++entity_to_index[page]->used;
+  index_to_entity.push_back(ent);
 }
 
 template <typename T> void component_array<T>::remove_data(entity ent) {
-  assert(entity_to_index_map.find(ent) != entity_to_index_map.end() &&
-         "Removing non-existent component.");
+  assert(has_data(ent) && "Removing non-existent component.");
 
-  // Copy element at end into deleted element's place to maintain density
-  size_t index_of_removed_entity = entity_to_index_map[ent];
-  size_t index_of_last_element = size - 1;
-  m_component_array[index_of_removed_entity] =
-      m_component_array[index_of_last_element];
+  // Move element at end into deleted element's place to maintain density
+  std::size_t index_of_removed_entity = sparse_index(ent);
+  std::size_t index_of_last_element = index_to_entity.size() - 1;
+  if (index_of_removed_entity != index_of_last_element) {
+    *slot(index_of_removed_entity) = std::move(*slot(index_of_last_element));
+  }
+  slot(index_of_last_element)->~T();
 
-  // Update map to point to moved spot
-  entity entity_of_last_element = index_to_entity_map[index_of_last_element];
-  entity_to_index_map[entity_of_last_element] = index_of_removed_entity;
-  index_to_entity_map[index_of_removed_entity] = entity_of_last_element;
+  // Update sparse slot to point to moved spot
+  entity entity_of_last_element = index_to_entity[index_of_last_element];
+  entity_to_index[entity_index(entity_of_last_element) / SPARSE_PAGE_SIZE]
+      ->index[entity_index(entity_of_last_element) % SPARSE_PAGE_SIZE] =
+      static_cast<std::uint32_t>(index_of_removed_entity);
+  index_to_entity[index_of_removed_entity] = entity_of_last_element;
+  index_to_entity.pop_back();
 
-  entity_to_index_map.erase(ent);
-  index_to_entity_map.erase(index_of_last_element);
+  // Clear the removed entity's sparse slot, releasing the page once unused
+  std::size_t page = entity_index(ent) / SPARSE_PAGE_SIZE;
+  entity_to_index[page]->index[entity_index(ent) % SPARSE_PAGE_SIZE] =
+      INVALID_INDEX;
+  if (--entity_to_index[page]->used == 0) {
+    entity_to_index[page].reset();
+  }
 
-  --size;
+  // Release trailing packed pages, keeping one empty page spare so that
+  // adding and removing around a page boundary does not thrash the allocator
+  std::size_t pages_needed =
+      (index_to_entity.size() + COMPONENT_PAGE_SIZE - 1) / COMPONENT_PAGE_SIZE;
+  while (m_pages.size() > pages_needed + 1) {
+    std::allocator<T>().deallocate(m_pages.back(), COMPONENT_PAGE_SIZE);
+    m_pages.pop_back();
+  }
 }
 
 template <typename T> T &component_array<T>::get_data(entity ent) {
-  assert(entity_to_index_map.find(ent) != entity_to_index_map.end() &&
-         "Retrieving non-existent component.");
+  assert(has_data(ent) && "Retrieving non-existent component.");
 
   // Return a reference to the entity's component
-  return m_component_array[entity_to_index_map[ent]];
+  return *slot(sparse_index(ent));
 }
 
 template <typename T> bool component_array<T>::has_data(entity ent) {
-  return entity_to_index_map.find(ent) != entity_to_index_map.end();
+  return sparse_index(ent) != INVALID_INDEX;
 }
 
 template <typename T> void component_array<T>::entity_destroyed(entity ent) {
-  if (entity_to_index_map.find(ent) != entity_to_index_map.end()) {
+  if (has_data(ent)) {
     // Remove the entity's component if it existed
     remove_data(ent);
   }
-}
\ No newline at end of file
+}
@@ -38,11 +38,21 @@ public:
   // Network ID management
   uint32_t AllocateNetworkId(); // Host only
   void RegisterNetworkEntity(uint32_t netId, entity ent);
-  void UnregisterNetworkEntity(entity ent); // NEW: Unregister entity when destroyed
+  void UnregisterNetworkEntity(entity ent); // Unregister entity when destroyed
+  // NULL_ENTITY if no entity has the ID
   entity GetEntityByNetworkId(uint32_t netId) const;
+  // 0 (the invalid ID) if the entity isn't registered
+  uint32_t GetNetworkIdByEntity(entity ent) const;
   HSteamNetConnection GetConnectionByNetworkId(uint32_t netId) const;
   void SendToConnection(HSteamNetConnection conn, const void *data, size_t size,
                         int nSendFlags = k_nSteamNetworkingSend_Reliable);
+  // Queue a message for FlushMessages(), which hands every queued message to
+  // the sockets library in a single SendMessages call
+  void QueueMessage(HSteamNetConnection conn, const void *data, size_t size,
+                    int nSendFlags = k_nSteamNetworkingSend_Reliable);
+  void FlushMessages();
+  // Host: every client connection. Client: the connection to the server
+  std::vector<HSteamNetConnection> GetPeerConnections() const;
 
   // Callbacks
   using PacketReceivedCallback =
@@ -78,9 +88,14 @@ private:
   uint32_t m_localPlayerId = 0;
 
   PacketReceivedCallback m_packetCallback;
+  // Messages queued by QueueMessage() (owned until sent)
+  std::vector<SteamNetworkingMessage_t *> m_outgoingMessages;
 
   // Network ID management
   uint32_t m_nextNetworkId = 1; // Start from 1, 0 is invalid
-  std::map<uint32_t, entity> m_networkIdToEntity;
+  // IDs are handed out densely from 1, so both directions are flat tables:
+  // entity by network ID, and network ID by entity_index
+  std::vector<entity> m_networkIdToEntity;
+  std::vector<uint32_t> m_entityToNetworkId;
   std::map<uint32_t, HSteamNetConnection> m_networkIdToConnection;
 };
@@ -7,13 +7,13 @@ enum class PacketType : uint8_t {
   JoinRequest,
   JoinAccept,
   PlayerInput,
-  GameStateUpdate,
   ReserveNetworkIDRequest,
   NetworkIDReserved,
   NetworkIDGranted,
   EntityInitPacket,
-  ComponentBatchUpdate,
-  OwnershipTransferPacket
+  ComponentSnapshot,
+  OwnershipTransferPacket,
+  SnapshotAck
 };
 
 #pragma pack(push, 1)
@@ -44,22 +44,6 @@ struct PlayerInputPacket {
   // Add other inputs as needed
 };
 
-struct EntityStateData {
-  uint32_t entity_id;
-  float position_x;
-  float position_y;
-  float velocity_x;
-  float velocity_y;
-  // Add other state data like animation frame, etc.
-};
-
-struct GameStateUpdatePacket {
-  PacketHeader header;
-  uint32_t entity_count;
-  // Followed by entity_count * EntityStateData
-  // We'll handle the variable size payload in serialization
-};
-
 // Network ID Reservation Packets
 struct ReserveNetworkIDRequestPacket {
   PacketHeader header;
@@ -89,13 +73,24 @@ struct EntityInitPacketHeader {
   // 2. component_count * [component_id (uint8_t)][size (uint16_t)][data]  - Serialized components
 };
 
-// Component Batch Update Packet
-struct ComponentBatchUpdatePacket {
+// Component Snapshot Packet
+// The component updates of many entities for one tick, packed up to
+// SNAPSHOT_MTU bytes; a tick's updates take as many of these as they need.
+// header.sequence_number counts the snapshots sent to one peer, which acks
+// them and drops any that arrive after a newer one
+struct ComponentSnapshotPacket {
   PacketHeader header;
-  uint32_t network_id;           // Entity to update
-  uint32_t component_count;      // Number of components in this batch
-  // Followed by serialized components:
-  // For each component: [component_id (uint8_t)][size (uint16_t)][data]
+  uint16_t entity_count;
+  // Followed by entity_count * [ComponentSnapshotEntry][update bytes]
+};
+
+struct ComponentSnapshotEntry {
+  uint32_t network_id;
+  uint8_t component_count;
+  uint16_t size;                 // Bytes of the update that follows
+  // The update is a bit stream (see bit_stream.hpp) with, for each component,
+  // its id (COMPONENT_ID_BITS) and then either a quantized delta for
+  // Transform and Rigidbody (see component_delta.hpp) or [size (16 bits)][data]
 };
 
 // Ownership Transfer Packet
@@ -105,4 +100,13 @@ struct OwnershipTransferPacketData {
   uint32_t new_owner_player_id;
 };
 
+// Snapshot Ack Packet
+// Acknowledges the snapshots applied from a peer. Every ack repeats the
+// previous 32, so a lost ack is covered by the next one
+struct SnapshotAckPacket {
+  PacketHeader header;
+  uint32_t latest_sequence;      // Newest snapshot applied
+  uint32_t received_mask;        // Bit i: latest_sequence - 1 - i was applied
+};
+
 #pragma pack(pop)
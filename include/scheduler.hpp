@@ -0,0 +1,60 @@
+#pragma once
+
+#include "component.hpp"
+#include "thread_pool.hpp"
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Components a scheduled step reads and writes
+struct component_access {
+    signature reads;
+    signature writes;
+    // Runs alone on the calling thread (input devices, networking, or any
+    // other state outside the ECS that is not safe to touch concurrently)
+    bool exclusive = false;
+};
+
+/*
+ * Runs the per-frame system steps, overlapping steps whose declared
+ * component accesses do not conflict.
+ *
+ * Steps are added in program order. Two steps conflict when either writes a
+ * component the other reads or writes, or either is exclusive; a step runs
+ * after every earlier step it conflicts with, so the result matches running
+ * the steps sequentially in the order they were added. Steps must not make
+ * structural changes directly - they record them with g_conductor.commands()
+ * for the next sync point.
+ */
+class scheduler {
+  public:
+    using step_function = std::function<void(float)>;
+
+    // Defaults to one worker per spare hardware thread
+    scheduler();
+    explicit scheduler(std::size_t worker_count);
+
+    void add(std::string name, component_access access, step_function run);
+    // Run every step for one frame
+    void run(float delta_time);
+
+    // Pool for steps that split their own entity loop into parallel chunks
+    thread_pool &pool() { return m_pool; }
+
+  private:
+    struct step {
+        std::string name;
+        component_access access;
+        step_function run;
+    };
+
+    static bool conflicts(const component_access &a, const component_access &b);
+    void build_stages();
+
+    thread_pool m_pool;
+    std::vector<step> m_steps;
+    // Indices into m_steps; the steps of one stage may run concurrently
+    std::vector<std::vector<std::size_t>> m_stages;
+    bool m_stages_dirty = false;
+};
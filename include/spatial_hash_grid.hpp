@@ -0,0 +1,59 @@
+#pragma once
+
+#include "broad_phase.hpp"
+#include "entity.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*
+ * Uniform grid broad-phase keyed by a hash of the cell coordinates.
+ *
+ * Boxes are inserted each frame and every box is listed in all cells it
+ * covers. collect_pairs() then only compares boxes that share a cell, so the
+ * cost follows the number of nearby boxes rather than the square of all of
+ * them. The cell size should be around the size of the common (small)
+ * objects; large objects such as the ground just cover more cells.
+ */
+class spatial_hash_grid : public broad_phase {
+  public:
+    explicit spatial_hash_grid(float cell_size = 64.0f);
+
+    // Forget every box, keeping the cell lists allocated for the next frame
+    void begin_frame() override;
+    void insert(entity ent, float x, float y, float width, float height, bool moved, std::uint32_t layer,
+                std::uint32_t mask) override;
+    void collect_pairs(std::vector<entity_pair> &pairs) override;
+
+    std::size_t size() const { return m_boxes.size(); }
+
+  private:
+    struct box {
+        entity ent;
+        float min_x, min_y, max_x, max_y;
+        // Range of covered cells
+        std::int32_t cell_min_x, cell_min_y, cell_max_x, cell_max_y;
+        bool moved;
+        std::uint32_t layer, mask;
+    };
+
+    struct used_cell {
+        std::int32_t x, y;
+        std::vector<std::uint32_t> *boxes;
+    };
+
+    std::int32_t cell_coordinate(float value) const;
+    static std::uint64_t cell_key(std::int32_t x, std::int32_t y);
+
+    float m_cell_size;
+    float m_inverse_cell_size;
+    std::vector<box> m_boxes;
+    // Cell key -> indices into m_boxes, in insertion order
+    std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> m_cells;
+    // Cells with at least one box this frame
+    std::vector<used_cell> m_used_cells;
+    // Scratch pairs of box indices
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> m_box_pairs;
+};
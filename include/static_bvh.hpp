@@ -0,0 +1,56 @@
+#pragma once
+
+#include "collision_layers.hpp"
+#include "entity.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Bounding volume hierarchy over boxes that never move, such as level
+ * geometry.
+ *
+ * The tree is built once from every static box and then only queried, so
+ * moving bodies find the static boxes they touch in logarithmic time instead
+ * of being paired against each of them every frame. Nodes are stored in one
+ * flat array with children allocated next to each other.
+ */
+class static_bvh {
+  public:
+    struct box {
+        entity ent;
+        float min_x, min_y, max_x, max_y;
+        std::uint32_t layer = LAYER_ALL;
+        std::uint32_t mask = LAYER_ALL;
+    };
+
+    // Replace the tree with one built over boxes
+    void build(std::vector<box> boxes);
+    void clear();
+
+    // Append every static entity whose box strictly overlaps the query box
+    // and whose layers interact with the querying body's
+    void query(float x, float y, float width, float height, std::uint32_t layer, std::uint32_t mask,
+               std::vector<entity> &hits) const;
+
+    std::size_t size() const { return m_boxes.size(); }
+    bool empty() const { return m_boxes.empty(); }
+
+  private:
+    struct node {
+        float min_x, min_y, max_x, max_y;
+        // Leaf: first box and box count. Inner: index of the left child (the
+        // right child follows it) and a count of 0
+        std::uint32_t first;
+        std::uint32_t count;
+    };
+
+    // Most boxes kept in one leaf
+    static constexpr std::uint32_t MAX_LEAF_BOXES = 4;
+
+    // Build the subtree of a node covering m_boxes[first, first + count)
+    void build_node(std::uint32_t node_index, std::uint32_t first, std::uint32_t count);
+
+    std::vector<box> m_boxes;
+    std::vector<node> m_nodes;
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "broad_phase.hpp"
+#include "entity.hpp"
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/*
+ * Incremental sweep-and-prune broad-phase.
+ *
+ * Box endpoints are kept sorted along both axes between frames and repaired
+ * with an insertion sort. Most entities barely move from one frame to the
+ * next, so the lists are nearly sorted and the repair is close to linear.
+ * Every swap of a start endpoint with an end endpoint is the moment two
+ * boxes start or stop overlapping along that axis, so the set of overlapping
+ * pairs is maintained from the swaps alone.
+ *
+ * Entities that are not inserted in a frame (inactive, no longer collidable
+ * or destroyed) are dropped, ending all of their overlaps.
+ */
+class sweep_and_prune : public broad_phase {
+  public:
+    void begin_frame() override;
+    void insert(entity ent, float x, float y, float width, float height, bool moved, std::uint32_t layer,
+                std::uint32_t mask) override;
+    void collect_pairs(std::vector<entity_pair> &pairs) override;
+
+  private:
+    struct proxy {
+        entity ent;
+        std::array<float, 2> min;
+        std::array<float, 2> max;
+        // Insertion order within the current frame
+        std::uint32_t rank;
+        std::uint32_t layer;
+        std::uint32_t mask;
+        bool moved;
+        bool seen;
+        bool alive;
+    };
+
+    struct endpoint {
+        float value;
+        std::uint32_t proxy;
+        bool is_min;
+    };
+
+    // Sort order of endpoints. At equal values ends come before starts, so
+    // boxes that only touch don't count as overlapping
+    static bool endpoint_less(const endpoint &a, const endpoint &b) {
+        return a.value < b.value || (a.value == b.value && !a.is_min && b.is_min);
+    }
+    static std::uint64_t pair_key(std::uint32_t a, std::uint32_t b);
+
+    bool overlaps(const proxy &a, const proxy &b) const;
+    // Drop proxies that were not inserted this frame
+    void remove_unseen();
+    // Refresh endpoint values and restore the order, tracking overlap changes
+    void sort_axis(std::size_t axis);
+    void add_pair(std::uint32_t a, std::uint32_t b);
+    void remove_pair(std::uint32_t a, std::uint32_t b);
+
+    std::vector<proxy> m_proxies;
+    std::vector<std::uint32_t> m_free_proxies;
+    std::unordered_map<entity, std::uint32_t> m_proxy_of;
+    std::array<std::vector<endpoint>, 2> m_axes;
+    // Overlapping proxy pairs, keyed by (lower index, higher index)
+    std::unordered_set<std::uint64_t> m_pairs;
+    std::uint32_t m_next_rank = 0;
+
+    // Scratch list of (rank, rank) -> pair for sorting output
+    std::vector<std::pair<std::pair<std::uint32_t, std::uint32_t>, entity_pair>> m_ranked;
+};
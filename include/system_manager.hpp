@@ -1,5 +1,6 @@
 #include <unordered_map>
 #include <memory>
+#include <vector>
 #include <cassert>
 #include "systems/game_system.hpp"
 #include "component.hpp"
@@ -14,6 +15,9 @@ public:
 	template<typename T> void set_signature(signature signature);
 	void entity_destroyed(entity entity);
 	void entity_signature_changed(entity entity, signature entity_signature);
+	// Batched versions - one pass over the systems for the whole batch
+	void entities_destroyed(const std::vector<entity>& entities);
+	void entities_signature_changed(const std::vector<entity>& entities, signature entity_signature);
 private:
 	// Map from system type string pointer to a signature
 	std::unordered_map<const char*, signature> signatures{};
@@ -11,4 +11,6 @@ extern conductor g_conductor;
 class basic_render_system : public game_system {
     public:
     void update(sf::RenderWindow& window);
+    // Debug overlay: outline the collision bounds of every active body
+    void draw_hitboxes(sf::RenderWindow& window);
 };
@@ -3,14 +3,198 @@
 
 #include "systems/game_system.hpp"
 #include "conductor.hpp"
+#include "broad_phase.hpp"
+#include "static_bvh.hpp"
+#include "thread_pool.hpp"
+#include "help_functions.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
 
 extern conductor g_conductor;
 
-class jump_system;
+struct rigidbody;
+struct transform;
+
+// Broad-phase used to find candidate pairs
+enum class broad_phase_mode {
+    // Uniform grid rebuilt every frame (default)
+    spatial_hash,
+    // Persistent sorted endpoints, repaired incrementally each frame
+    sweep_and_prune
+};
+
+// Stage of a contact between two bodies, as of the last update
+enum class collision_phase {
+    // Started touching
+    enter,
+    // Still touching
+    stay,
+    // Stopped touching, or either body is gone
+    exit
+};
+
+struct collision_event {
+    entity entity1;
+    entity entity2;
+    collision_phase phase;
+    // Whether each body landed on the other: pushed up out of it while
+    // falling, or resting on it since
+    bool landed1 = false;
+    bool landed2 = false;
+    // Either body is a trigger, so the bodies weren't separated
+    bool trigger = false;
+};
 
 class collision_detection_system : public game_system {
     public:
-    void update(jump_system& jump_system);
+    collision_detection_system();
+    // Detects and resolves collisions. Given a pool, candidate pairs are
+    // tested in parallel with the same result as the sequential path
+    void update(thread_pool* pool = nullptr);
+    // Contact events of the last update, ordered by entity pair
+    const std::vector<collision_event>& events() const { return m_events; }
+    // Call fn(event) for every event between an entity with all components
+    // of first and one with all components of second, with the event turned
+    // so entity1 is the one matching first. An event matching both ways
+    // (e.g. with the same signature twice) is visited once each way
+    template <typename Fn> void for_each_event(signature first, signature second, Fn&& fn) const;
+    // Recompute a body's collision bounds from its transform
+    static void sync_bounds(rigidbody& rigidbody_comp, const transform& transform_comp);
+    void set_broad_phase(broad_phase_mode mode);
+
+    private:
+    // Separation of one candidate pair along its axis of least penetration
+    struct contact {
+        entity entity1;
+        entity entity2;
+        // 0 for X, 1 for Y
+        int axis;
+        // Movement of each entity along the axis (0 for an entity that stays put)
+        float separation1;
+        float separation2;
+    };
+    struct pending_contact {
+        bool valid;
+        contact resolved;
+    };
+
+    // Narrow-phase test of one candidate pair, only reading components.
+    // Returns false if the pair needs no separation
+    bool compute_contact(entity entity1, entity entity2, bool was_colliding, contact& result) const;
+    // Returns LANDED_FIRST and/or LANDED_SECOND for the entities that landed
+    std::uint8_t apply_contact(const contact& resolved);
+    // Returns whether the entity landed
+    bool apply_separation(entity ent, int axis, float separation);
+    // Narrow-phase of every candidate pair, in parallel when given a pool
+    void resolve_pairs(thread_pool* pool);
+    // Test every candidate pair's boxes at their last positions, in batches
+    // of pairs sharing their first entity
+    void test_last_positions();
+    // Continuous collision of a fast body against the static tree: stop it
+    // at the first static body its move from last_position would hit
+    void sweep_against_static(entity ent, transform& transform_comp, rigidbody& rigidbody_comp);
+    // Turn this update's contacts into events against the last update's
+    void publish_events();
+    // Whether an entity is still an active collidable body
+    bool is_colliding_body(entity ent) const;
+    // Bodies in contact that sleep and wake together
+    struct sleep_island {
+        // Empty when the island is free
+        std::vector<entity> members;
+        // Sleeping members seen this update
+        std::uint32_t seen = 0;
+        // A member was woken from outside
+        bool disturbed = false;
+    };
+
+    // Put islands of bodies that have been at rest long enough to sleep
+    void update_sleep();
+    std::uint32_t find_island_root(std::uint32_t slot);
+    std::uint32_t allocate_island();
+    void wake_island(std::uint32_t index);
+    // Wake islands that lost a member or had one woken since the last update
+    void wake_disturbed_islands();
+    // Rebuild the static tree from the static bodies seen this update
+    void rebuild_static_tree();
+
+    std::unique_ptr<broad_phase> m_broad_phase;
+    // Candidate pairs from the broad-phase (reused between updates)
+    std::vector<entity_pair> m_pairs;
+    // Whether each pair in m_pairs overlapped at the last positions
+    std::vector<std::uint8_t> m_was_colliding;
+    // Scratch for the batched box tests
+    rectangle_batch m_partner_boxes;
+    std::vector<std::uint32_t> m_hits;
+    // LANDED_* flags of each pair in m_pairs
+    std::vector<std::uint8_t> m_pair_landed;
+    // Contacts computed in parallel, one slot per pair
+    std::vector<pending_contact> m_contacts;
+    // Entities pushed by contacts applied so far in this update
+    entity_set m_displaced;
+
+    // Sleep islands, indexed by rigidbody::sleep_island
+    std::vector<sleep_island> m_islands;
+    std::vector<std::uint32_t> m_free_islands;
+    // Union-find over the awake bodies (reused between updates)
+    std::vector<entity> m_awake_bodies;
+    // Entity index -> union-find slot
+    std::vector<std::uint32_t> m_body_slots;
+    std::vector<std::uint32_t> m_island_parents;
+    // Per union-find root: fewest still frames of a member, and the island it sleeps as
+    std::vector<std::uint16_t> m_island_still;
+    std::vector<std::uint32_t> m_root_islands;
+
+    // Static bodies are kept out of the broad-phase and only queried. The tree
+    // is rebuilt whenever the set of static bodies changes (one is added,
+    // removed, deactivated or has is_static flipped); otherwise static bodies
+    // are assumed not to move or resize after it was built
+    static_bvh m_static_tree;
+    // Static bodies the tree was built from, and the ones seen this update
+    std::vector<entity> m_static_entities;
+    std::vector<entity> m_seen_static_entities;
+    // Active collidable bodies that aren't static (reused between updates)
+    std::vector<entity> m_dynamic_entities;
+    // Moving bodies to test against the static tree (reused between updates)
+    std::vector<entity> m_static_queries;
+    std::vector<entity> m_static_hits;
+    // Bodies inserted as moved this update
+    entity_set m_moved;
+
+    // A pair of bodies in contact, ordered by entity index, with its LANDED_* flags
+    struct touching_pair {
+        entity_pair pair;
+        std::uint8_t landed;
+        bool trigger;
+    };
+    static constexpr std::uint8_t LANDED_FIRST = 1;
+    static constexpr std::uint8_t LANDED_SECOND = 2;
+    // Contacts found this update: candidate pairs, swept hits and untouched
+    // pairs carried over. Sorted by pair at the end of the update
+    std::vector<touching_pair> m_touching;
+    std::vector<touching_pair> m_last_touching;
+    std::vector<collision_event> m_events;
 };
 
+// Template function definitions
+template <typename Fn>
+void collision_detection_system::for_each_event(signature first, signature second, Fn&& fn) const {
+    for (const auto& event : m_events) {
+        // Bodies that are gone still get their exit event, but match nothing
+        if (!g_conductor.is_alive(event.entity1) || !g_conductor.is_alive(event.entity2)) {
+            continue;
+        }
+        signature signature1 = g_conductor.get_signature(event.entity1);
+        signature signature2 = g_conductor.get_signature(event.entity2);
+        if ((signature1 & first) == first && (signature2 & second) == second) {
+            fn(event);
+        }
+        if ((signature2 & first) == first && (signature1 & second) == second) {
+            collision_event turned{event.entity2, event.entity1, event.phase, event.landed2, event.landed1,
+                                   event.trigger};
+            fn(turned);
+        }
+    }
+}
+
 #endif
\ No newline at end of file
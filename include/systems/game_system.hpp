@@ -1,9 +1,11 @@
 #pragma once
 
 #include "../entity.hpp"
-#include <set>
+#include "../entity_set.hpp"
 
 class game_system {
 public:
-  std::set<entity> entities;
-};
\ No newline at end of file
+  // Entities matching the system's signature. Unordered by default; systems
+  // that need a deterministic order call entities.set_sorted(true).
+  entity_set entities;
+};
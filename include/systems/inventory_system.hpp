@@ -5,13 +5,18 @@
 #include "game_system.hpp"
 #include "item_system.hpp"
 #include <SFML/Graphics/RenderWindow.hpp>
+#include <vector>
 
 extern conductor g_conductor;
 
+class collision_detection_system;
+
 class inventory_system : public game_system {
 public:
   void update(item_system &item_sys);
-  void attempt_pickups(item_system &item_sys); // store item entity in inventory
+  // Store the items each inventory touched in the last collision update
+  void attempt_pickups(item_system &item_sys,
+                       const collision_detection_system &collisions);
   void drop(item_system &item_sys, entity ent,
             int slot); // remove item entity from inventory
   void draw_ui(sf::RenderWindow &window, entity player_entity);
@@ -4,8 +4,13 @@
 #include "systems/game_system.hpp"
 #include "conductor.hpp"
 
+class collision_detection_system;
+
 class jump_system : public game_system {
     public:
+    // Reset the jump of every entity that landed on something in the last
+    // collision update
+    void update(const collision_detection_system& collisions);
     void reset_jump(entity e);
 };
 
@@ -1,11 +1,15 @@
 #pragma once
 
+#include "bit_stream.hpp"
+#include "component_delta.hpp"
 #include "component_serialization.hpp"
 #include "entity.hpp"
 #include "network_manager.hpp"
 #include "system_manager.hpp"
+#include <array>
 #include <cstdint>
 #include <map>
+#include <utility>
 #include <vector>
 
 class network_system : public game_system {
@@ -26,7 +30,6 @@ public:
 
 private:
   // Old methods
-  void broadcast_state();
   void send_input();
   void update_remote_entities(float dt);
 
@@ -37,17 +40,107 @@ private:
   void handle_network_id_granted(const void *data, size_t size);
   void handle_entity_init(const void *data, size_t size);
   void handle_ownership_transfer(const void *data, size_t size);
-  void handle_component_batch_update(const void *data, size_t size);
+  void handle_component_snapshot(HSteamNetConnection conn, const void *data,
+                                 size_t size);
+  void handle_snapshot_ack(HSteamNetConnection conn, const void *data,
+                           size_t size);
+  // Apply component_count component updates of a snapshot entry to ent
+  void read_component_updates(entity ent, uint32_t component_count,
+                              BitReader &reader);
 
   // Network sync
-  void broadcast_component_updates();
-  void send_component_updates();
+  // Snapshot messages remembered per peer until acked
+  static constexpr uint32_t SNAPSHOT_HISTORY = 64;
+
+  // Networked state of an entity this tick, shared by every peer's snapshot
+  struct replicated_entity {
+    entity ent;
+    uint32_t network_id;
+    bool has_transform;
+    bool has_rigidbody;
+    QuantizedTransform transform;
+    QuantizedRigidbody rigidbody;
+    uint32_t first_component; // Range in m_tickComponents
+    uint32_t component_count;
+  };
+  // A component sent whole: its serialized bytes (a range in
+  // m_tickComponentBytes) and their hash
+  struct replicated_component {
+    ComponentID id;
+    uint64_t hash;
+    uint32_t offset;
+    uint32_t size;
+  };
+  // The state of an entity's components a peer has acked, which the next
+  // update is encoded against
+  struct entity_baseline {
+    entity ent = NULL_ENTITY;
+    bool owned_by_peer = false; // Updated by the peer, so never sent back
+    bool has_transform = false;
+    bool has_rigidbody = false;
+    uint16_t component_mask = 0; // Bit per ComponentID with an acked hash
+    QuantizedTransform transform;
+    QuantizedRigidbody rigidbody;
+    uint64_t component_hashes[1 << COMPONENT_ID_BITS];
+  };
+  // What a snapshot message carried for an entity
+  struct sent_entity {
+    entity ent;
+    uint32_t transform_dirty;
+    uint32_t rigidbody_dirty;
+    QuantizedTransform transform;
+    QuantizedRigidbody rigidbody;
+    uint32_t first_component; // Range in sent_snapshot::components
+    uint32_t component_count;
+  };
+  struct sent_snapshot {
+    uint32_t sequence = 0;
+    bool pending = false; // Sent and not acked yet
+    std::vector<sent_entity> entities;
+    std::vector<std::pair<ComponentID, uint64_t>> components;
+  };
+  struct peer_replication {
+    // Sending
+    uint32_t next_sequence = 1;
+    std::vector<entity_baseline> baselines; // Indexed by entity_index
+    std::array<sent_snapshot, SNAPSHOT_HISTORY> history;
+    // Host: the peer's player, whose position decides what's relevant to it
+    entity focus = NULL_ENTITY;
+    // Priority accumulated since each entity was last sent, by entity_index
+    std::vector<float> priorities;
+    // Receiving
+    uint32_t received_sequence = 0; // Newest snapshot applied, 0 for none
+    uint32_t received_mask = 0;     // As in SnapshotAckPacket
+    bool ack_pending = false;
+  };
+
+  // Build and queue this tick's snapshots for every peer (the clients, or
+  // the server) and ack theirs, then send it all in one batch
+  void send_component_snapshots();
+  // Capture the networked state of every entity we replicate into
+  // m_tickEntities
+  void capture_entities();
+  // Pack the entities relevant to the peer whose state differs from its
+  // baselines into m_snapshots, recording what was sent in its history
+  void build_snapshots(peer_replication &peer);
+  // Write the components of current that differ from baseline (all of them
+  // without one), returning how many were written. What was written is
+  // recorded in sent and m_entityComponents
+  uint32_t write_component_updates(const replicated_entity &current,
+                                   const entity_baseline *baseline,
+                                   sent_entity &sent, BitWriter &writer);
+  // Fold an acked snapshot into the peer's baselines
+  void apply_snapshot_ack(peer_replication &peer, sent_snapshot &snapshot);
   void send_all_entities_to_client(HSteamNetConnection conn);
-  bool has_component_changed(entity ent, ComponentID comp_id, 
-                             const std::vector<uint8_t>& current_data);
 
   // State
   uint32_t m_pendingGrantedId = 0; // For clients waiting for ID grant
   std::vector<uint32_t> m_reservedIds; // IDs that are in use
-  std::map<entity, std::map<ComponentID, std::vector<uint8_t>>> m_lastSentComponentData; // Change tracking
+  std::map<HSteamNetConnection, peer_replication> m_peers;
+  std::vector<replicated_entity> m_tickEntities;
+  std::vector<replicated_component> m_tickComponents;
+  std::vector<uint8_t> m_tickComponentBytes;
+  std::vector<std::vector<uint8_t>> m_snapshots; // Messages built for a peer
+  std::vector<uint8_t> m_entityUpdate; // Scratch for one entity's update
+  std::vector<std::pair<ComponentID, uint64_t>> m_entityComponents;
 };
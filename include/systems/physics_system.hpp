@@ -3,12 +3,14 @@
 
 #include "systems/game_system.hpp"
 #include "conductor.hpp"
+#include "thread_pool.hpp"
 
 extern conductor g_conductor;
 
 class physics_system : public game_system {
     public:
-    void update(float delta_time);
+    // Integrates every body, split into parallel chunks when given a pool
+    void update(float delta_time, thread_pool *pool = nullptr);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Fixed set of worker threads for running independent tasks.
+ *
+ * The thread that submits a batch helps execute queued tasks while it waits
+ * for the batch to finish, so batches may be submitted from inside a running
+ * task (for example a system splitting its entity loop while it runs
+ * alongside other systems) without deadlocking. With zero workers every task
+ * runs inline on the calling thread.
+ */
+class thread_pool {
+  public:
+    explicit thread_pool(std::size_t worker_count);
+    ~thread_pool();
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    std::size_t worker_count() const { return m_workers.size(); }
+
+    // Run every task and wait until all of them have finished. If any task
+    // throws, the first exception caught is rethrown once the batch is done
+    void run_all(const std::vector<std::function<void()>> &tasks);
+
+    // Call body(begin, end) over [0, count) split into chunks of at least
+    // min_chunk items, and wait until every chunk has finished
+    void parallel_for(std::size_t count, std::size_t min_chunk,
+                      const std::function<void(std::size_t, std::size_t)> &body);
+
+  private:
+    void worker_loop();
+    // Run one queued task if there is any, returns false when the queue was empty
+    bool run_one(std::unique_lock<std::mutex> &lock);
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_queue;
+    std::mutex m_mutex;
+    // Signalled when tasks are queued or the pool is stopping
+    std::condition_variable m_task_ready;
+    // Signalled whenever a task finishes
+    std::condition_variable m_task_done;
+    bool m_stopping = false;
+};
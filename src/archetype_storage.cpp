@@ -0,0 +1,115 @@
+#include "archetype_storage.hpp"
+#include <cassert>
+
+void archetype_storage::remove(entity ent, component_type type) {
+    assert(has(ent, type) && "Removing non-existent component.");
+
+    signature new_signature = m_archetypes[m_locations[entity_index(ent)].archetype_index].archetype_signature;
+    new_signature.set(type, false);
+    move_entity(ent, new_signature);
+}
+
+bool archetype_storage::has(entity ent, component_type type) const {
+    return located(ent) &&
+           m_archetypes[m_locations[entity_index(ent)].archetype_index].archetype_signature.test(type);
+}
+
+void archetype_storage::entity_destroyed(entity ent) {
+    if (located(ent)) {
+        remove_row(ent);
+    }
+}
+
+bool archetype_storage::located(entity ent) const {
+    entity index = entity_index(ent);
+    if (index >= m_locations.size() || m_locations[index].archetype_index == NO_ARCHETYPE) {
+        return false;
+    }
+    // A stale handle shares its index with a newer entity but not its generation
+    const entity_location &location = m_locations[index];
+    return m_archetypes[location.archetype_index].entities[location.row] == ent;
+}
+
+std::uint32_t archetype_storage::archetype_for(signature archetype_signature) {
+    auto it = m_archetype_lookup.find(archetype_signature);
+    if (it != m_archetype_lookup.end()) {
+        return it->second;
+    }
+
+    // First entity with this signature - create its archetype and columns
+    archetype arch;
+    arch.archetype_signature = archetype_signature;
+    for (component_type type = 0; type < MAX_COMPONENTS; ++type) {
+        if (archetype_signature.test(type)) {
+            assert(m_factories[type] && "Component not registered before use.");
+            arch.columns[type] = m_factories[type]();
+        }
+    }
+
+    std::uint32_t index = static_cast<std::uint32_t>(m_archetypes.size());
+    m_archetypes.push_back(std::move(arch));
+    m_archetype_lookup.insert({archetype_signature, index});
+    return index;
+}
+
+void archetype_storage::move_entity(entity ent, signature new_signature) {
+    entity index = entity_index(ent);
+    if (index >= m_locations.size()) {
+        m_locations.resize(static_cast<std::size_t>(index) + 1);
+    }
+
+    // An entity with no components lives in no archetype
+    if (new_signature.none()) {
+        remove_row(ent);
+        return;
+    }
+
+    std::uint32_t target_index = archetype_for(new_signature);
+    entity_location old_location = m_locations[index];
+    archetype &target = m_archetypes[target_index];
+
+    // Append a row to the target, moving over the components the entity keeps
+    for (component_type type = 0; type < MAX_COMPONENTS; ++type) {
+        if (!target.columns[type]) {
+            continue;
+        }
+        if (old_location.archetype_index != NO_ARCHETYPE &&
+            m_archetypes[old_location.archetype_index].columns[type]) {
+            target.columns[type]->push_moved_from(
+                *m_archetypes[old_location.archetype_index].columns[type], old_location.row);
+        } else {
+            target.columns[type]->push_default();
+        }
+    }
+    std::uint32_t new_row = static_cast<std::uint32_t>(target.entities.size());
+    target.entities.push_back(ent);
+
+    // Free the old row (this resets the location), then point at the new one
+    if (old_location.archetype_index != NO_ARCHETYPE) {
+        remove_row(ent);
+    }
+    m_locations[index] = entity_location{target_index, new_row};
+}
+
+void archetype_storage::remove_row(entity ent) {
+    entity_location location = m_locations[entity_index(ent)];
+    if (location.archetype_index == NO_ARCHETYPE) {
+        return;
+    }
+    archetype &arch = m_archetypes[location.archetype_index];
+
+    // Swap the last row into the freed one to keep the archetype packed
+    for (auto &col : arch.columns) {
+        if (col) {
+            col->swap_remove(location.row);
+        }
+    }
+    entity last = arch.entities.back();
+    arch.entities[location.row] = last;
+    arch.entities.pop_back();
+    if (last != ent) {
+        m_locations[entity_index(last)].row = location.row;
+    }
+
+    m_locations[entity_index(ent)] = entity_location{};
+}
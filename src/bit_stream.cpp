@@ -0,0 +1,99 @@
+#include "bit_stream.hpp"
+#include <cstring>
+
+void BitWriter::WriteBits(uint32_t value, unsigned count) {
+    if (count == 0) {
+        return;
+    }
+    uint64_t mask = (count >= 32) ? 0xFFFFFFFFull : ((1ull << count) - 1);
+    m_scratch |= (static_cast<uint64_t>(value) & mask) << m_scratchBits;
+    m_scratchBits += count;
+    while (m_scratchBits >= 8) {
+        m_buffer.push_back(static_cast<uint8_t>(m_scratch & 0xFF));
+        m_scratch >>= 8;
+        m_scratchBits -= 8;
+    }
+}
+
+void BitWriter::WriteSigned(int32_t value, unsigned count) {
+    WriteBits(static_cast<uint32_t>(value), count);
+}
+
+void BitWriter::WriteFloat(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    WriteBits(bits, 32);
+}
+
+void BitWriter::WriteBytes(const uint8_t *data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        WriteBits(data[i], 8);
+    }
+}
+
+void BitWriter::Flush() {
+    if (m_scratchBits > 0) {
+        m_buffer.push_back(static_cast<uint8_t>(m_scratch & 0xFF));
+        m_scratch = 0;
+        m_scratchBits = 0;
+    }
+}
+
+uint32_t BitReader::ReadBits(unsigned count) {
+    if (count == 0) {
+        return 0;
+    }
+    if (m_bitPosition + count > m_size * 8) {
+        m_overflowed = true;
+        m_bitPosition = m_size * 8;
+        return 0;
+    }
+
+    uint32_t value = 0;
+    unsigned written = 0;
+    while (written < count) {
+        size_t byte = m_bitPosition / 8;
+        unsigned offset = static_cast<unsigned>(m_bitPosition % 8);
+        // Take as many bits as are left in this byte, up to what's still needed
+        unsigned take = 8 - offset;
+        if (take > count - written) {
+            take = count - written;
+        }
+        uint32_t bits = (m_data[byte] >> offset) & ((1u << take) - 1);
+        value |= bits << written;
+        written += take;
+        m_bitPosition += take;
+    }
+    return value;
+}
+
+int32_t BitReader::ReadSigned(unsigned count) {
+    if (count == 0) {
+        return 0;
+    }
+    uint32_t value = ReadBits(count);
+    // Sign-extend from the top bit of the field
+    if (count < 32 && (value & (1u << (count - 1))) != 0) {
+        value |= ~((1u << count) - 1);
+    }
+    return static_cast<int32_t>(value);
+}
+
+float BitReader::ReadFloat() {
+    uint32_t bits = ReadBits(32);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+bool BitReader::ReadBytes(uint8_t *out, size_t size) {
+    if (m_bitPosition + size * 8 > m_size * 8) {
+        m_overflowed = true;
+        m_bitPosition = m_size * 8;
+        return false;
+    }
+    for (size_t i = 0; i < size; ++i) {
+        out[i] = static_cast<uint8_t>(ReadBits(8));
+    }
+    return true;
+}
@@ -0,0 +1,34 @@
+#include "command_buffer.hpp"
+#include "conductor.hpp"
+#include <memory>
+#include <utility>
+
+void command_buffer::create_entity(entity_builder builder, std::function<void(entity)> on_created) {
+    // std::function needs a copyable target, so the move-only builder is shared
+    auto staged = std::make_shared<entity_builder>(std::move(builder));
+    record([staged, on_created = std::move(on_created)](conductor &world) {
+        entity ent = world.create_entity(*staged);
+        if (on_created) {
+            on_created(ent);
+        }
+    });
+}
+
+void command_buffer::destroy_entity(entity ent) {
+    // conductor::destroy_entity already ignores stale handles
+    record([ent](conductor &world) { world.destroy_entity(ent); });
+}
+
+void command_buffer::record(command recorded) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_commands.push_back(std::move(recorded));
+}
+
+void command_buffer::flush(conductor &world) {
+    // Index loop - commands may record further commands while playing back
+    for (std::size_t i = 0; i < m_commands.size(); ++i) {
+        command next = std::move(m_commands[i]);
+        next(world);
+    }
+    m_commands.clear();
+}
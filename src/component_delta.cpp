@@ -0,0 +1,176 @@
+#include "component_delta.hpp"
+#include "components/rigidbody.hpp"
+#include "components/transform.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Round to the nearest fixed point step, clamped to what fits in bits
+int32_t quantize(float value, float scale, unsigned bits) {
+    const float limit = static_cast<float>((1 << (bits - 1)) - 1);
+    return static_cast<int32_t>(std::lround(std::clamp(value * scale, -limit, limit)));
+}
+} // namespace
+
+QuantizedTransform QuantizeTransform(const transform &trans) {
+    QuantizedTransform result;
+    for (int axis = 0; axis < 2; ++axis) {
+        result.position[axis] = quantize(trans.position[axis], NET_POSITION_SCALE, NET_POSITION_BITS);
+        result.scale[axis] = trans.scale[axis];
+    }
+    return result;
+}
+
+QuantizedRigidbody QuantizeRigidbody(const rigidbody &rb) {
+    QuantizedRigidbody result;
+    for (int axis = 0; axis < 2; ++axis) {
+        float velocity = std::clamp(rb.velocity[axis], -MAX_NET_VELOCITY, MAX_NET_VELOCITY);
+        result.velocity[axis] = quantize(velocity, NET_VELOCITY_SCALE, NET_VELOCITY_BITS);
+        result.base_size[axis] = rb.base_size[axis];
+    }
+    result.mass = rb.Mass;
+    result.layer = rb.layer;
+    result.mask = rb.mask;
+    result.can_collide = rb.can_collide;
+    result.is_static = rb.is_static;
+    result.is_trigger = rb.is_trigger;
+    return result;
+}
+
+uint32_t TransformDirtyFields(const QuantizedTransform &current, const QuantizedTransform *baseline) {
+    if (baseline == nullptr) {
+        return TRANSFORM_DIRTY_POSITION_X | TRANSFORM_DIRTY_POSITION_Y | TRANSFORM_DIRTY_SCALE;
+    }
+    uint32_t dirty = 0;
+    if (current.position[0] != baseline->position[0]) {
+        dirty |= TRANSFORM_DIRTY_POSITION_X;
+    }
+    if (current.position[1] != baseline->position[1]) {
+        dirty |= TRANSFORM_DIRTY_POSITION_Y;
+    }
+    if (current.scale[0] != baseline->scale[0] || current.scale[1] != baseline->scale[1]) {
+        dirty |= TRANSFORM_DIRTY_SCALE;
+    }
+    return dirty;
+}
+
+uint32_t RigidbodyDirtyFields(const QuantizedRigidbody &current, const QuantizedRigidbody *baseline) {
+    if (baseline == nullptr) {
+        return RIGIDBODY_DIRTY_VELOCITY_X | RIGIDBODY_DIRTY_VELOCITY_Y | RIGIDBODY_DIRTY_PROPERTIES;
+    }
+    uint32_t dirty = 0;
+    if (current.velocity[0] != baseline->velocity[0]) {
+        dirty |= RIGIDBODY_DIRTY_VELOCITY_X;
+    }
+    if (current.velocity[1] != baseline->velocity[1]) {
+        dirty |= RIGIDBODY_DIRTY_VELOCITY_Y;
+    }
+    if (current.mass != baseline->mass || current.base_size[0] != baseline->base_size[0] ||
+        current.base_size[1] != baseline->base_size[1] || current.layer != baseline->layer ||
+        current.mask != baseline->mask || current.can_collide != baseline->can_collide ||
+        current.is_static != baseline->is_static || current.is_trigger != baseline->is_trigger) {
+        dirty |= RIGIDBODY_DIRTY_PROPERTIES;
+    }
+    return dirty;
+}
+
+void WriteTransformDelta(BitWriter &writer, const QuantizedTransform &current, uint32_t dirty) {
+    writer.WriteBits(dirty, TRANSFORM_DIRTY_BITS);
+    if (dirty & TRANSFORM_DIRTY_POSITION_X) {
+        writer.WriteSigned(current.position[0], NET_POSITION_BITS);
+    }
+    if (dirty & TRANSFORM_DIRTY_POSITION_Y) {
+        writer.WriteSigned(current.position[1], NET_POSITION_BITS);
+    }
+    if (dirty & TRANSFORM_DIRTY_SCALE) {
+        writer.WriteFloat(current.scale[0]);
+        writer.WriteFloat(current.scale[1]);
+    }
+}
+
+void WriteRigidbodyDelta(BitWriter &writer, const QuantizedRigidbody &current, uint32_t dirty) {
+    writer.WriteBits(dirty, RIGIDBODY_DIRTY_BITS);
+    if (dirty & RIGIDBODY_DIRTY_VELOCITY_X) {
+        writer.WriteSigned(current.velocity[0], NET_VELOCITY_BITS);
+    }
+    if (dirty & RIGIDBODY_DIRTY_VELOCITY_Y) {
+        writer.WriteSigned(current.velocity[1], NET_VELOCITY_BITS);
+    }
+    if (dirty & RIGIDBODY_DIRTY_PROPERTIES) {
+        writer.WriteFloat(current.mass);
+        writer.WriteFloat(current.base_size[0]);
+        writer.WriteFloat(current.base_size[1]);
+        writer.WriteBits(current.layer, 32);
+        writer.WriteBits(current.mask, 32);
+        writer.WriteBool(current.can_collide);
+        writer.WriteBool(current.is_static);
+        writer.WriteBool(current.is_trigger);
+    }
+}
+
+void ApplyTransformFields(QuantizedTransform &baseline, const QuantizedTransform &current, uint32_t dirty) {
+    if (dirty & TRANSFORM_DIRTY_POSITION_X) {
+        baseline.position[0] = current.position[0];
+    }
+    if (dirty & TRANSFORM_DIRTY_POSITION_Y) {
+        baseline.position[1] = current.position[1];
+    }
+    if (dirty & TRANSFORM_DIRTY_SCALE) {
+        baseline.scale[0] = current.scale[0];
+        baseline.scale[1] = current.scale[1];
+    }
+}
+
+void ApplyRigidbodyFields(QuantizedRigidbody &baseline, const QuantizedRigidbody &current, uint32_t dirty) {
+    if (dirty & RIGIDBODY_DIRTY_VELOCITY_X) {
+        baseline.velocity[0] = current.velocity[0];
+    }
+    if (dirty & RIGIDBODY_DIRTY_VELOCITY_Y) {
+        baseline.velocity[1] = current.velocity[1];
+    }
+    if (dirty & RIGIDBODY_DIRTY_PROPERTIES) {
+        int32_t velocity[2] = {baseline.velocity[0], baseline.velocity[1]};
+        baseline = current;
+        baseline.velocity[0] = velocity[0];
+        baseline.velocity[1] = velocity[1];
+    }
+}
+
+void ReadTransformDelta(BitReader &reader, transform &trans) {
+    uint32_t dirty = reader.ReadBits(TRANSFORM_DIRTY_BITS);
+    trans.last_position[0] = trans.position[0];
+    trans.last_position[1] = trans.position[1];
+    if (dirty & TRANSFORM_DIRTY_POSITION_X) {
+        trans.position[0] = static_cast<float>(reader.ReadSigned(NET_POSITION_BITS)) / NET_POSITION_SCALE;
+    }
+    if (dirty & TRANSFORM_DIRTY_POSITION_Y) {
+        trans.position[1] = static_cast<float>(reader.ReadSigned(NET_POSITION_BITS)) / NET_POSITION_SCALE;
+    }
+    if (dirty & TRANSFORM_DIRTY_SCALE) {
+        trans.scale[0] = reader.ReadFloat();
+        trans.scale[1] = reader.ReadFloat();
+    }
+}
+
+bool ReadRigidbodyDelta(BitReader &reader, rigidbody &rb) {
+    uint32_t dirty = reader.ReadBits(RIGIDBODY_DIRTY_BITS);
+    if (dirty & RIGIDBODY_DIRTY_VELOCITY_X) {
+        rb.velocity[0] = static_cast<float>(reader.ReadSigned(NET_VELOCITY_BITS)) / NET_VELOCITY_SCALE;
+    }
+    if (dirty & RIGIDBODY_DIRTY_VELOCITY_Y) {
+        rb.velocity[1] = static_cast<float>(reader.ReadSigned(NET_VELOCITY_BITS)) / NET_VELOCITY_SCALE;
+    }
+    if (dirty & RIGIDBODY_DIRTY_PROPERTIES) {
+        rb.Mass = reader.ReadFloat();
+        rb.base_size[0] = reader.ReadFloat();
+        rb.base_size[1] = reader.ReadFloat();
+        rb.layer = reader.ReadBits(32);
+        rb.mask = reader.ReadBits(32);
+        rb.can_collide = reader.ReadBool();
+        rb.is_static = reader.ReadBool();
+        rb.is_trigger = reader.ReadBool();
+        // Hitbox is only drawn, rebuild it from base_size
+        rb.Hitbox = sf::RectangleShape({rb.base_size[0], rb.base_size[1]});
+    }
+    return (dirty & (RIGIDBODY_DIRTY_VELOCITY_X | RIGIDBODY_DIRTY_VELOCITY_Y)) != 0;
+}
@@ -2,14 +2,30 @@
 #include <cassert>
 #include <memory>
 
+component_manager::component_manager(storage_mode mode) : mode(mode) {}
+
+void component_manager::prepare_entity(entity entity, signature entity_signature)
+{
+    // Sparse-set arrays are independent, only archetypes need the whole signature
+    if (mode == storage_mode::archetype)
+    {
+        archetypes.prepare(entity, entity_signature);
+    }
+}
+
 void component_manager::entity_destroyed(entity entity)
 {
+    if (mode == storage_mode::archetype)
+    {
+        // Drop the entity's row from its archetype
+        archetypes.entity_destroyed(entity);
+        return;
+    }
+
     // Notify each component array that an entity has been destroyed
     // If it has a component for that entity, it will remove it
-    for (auto const& pair : component_arrays)
+    for (component_type type = 0; type < next_component_type; ++type)
     {
-        auto const& component = pair.second;
-
-        component->entity_destroyed(entity);
+        component_arrays[type]->entity_destroyed(entity);
     }
 }
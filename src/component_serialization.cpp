@@ -56,7 +56,8 @@ void InitializeComponentSerializers() {
         [](const rigidbody &rb) -> std::vector<uint8_t> {
             std::vector<uint8_t> data;
             // Serialize: velocity (2 floats) + Mass (1 float) + base_size (2 floats) + can_collide (1 byte)
-            data.resize(sizeof(float) * 5 + 1); // 5 floats + 1 byte for bool
+            // + is_static (1 byte) + layer, mask (2 uint32) + is_trigger (1 byte)
+            data.resize(sizeof(float) * 5 + 2 + sizeof(uint32_t) * 2 + 1);
             size_t offset = 0;
             std::memcpy(data.data() + offset, rb.velocity, sizeof(float) * 2);
             offset += sizeof(float) * 2;
@@ -66,6 +67,14 @@ void InitializeComponentSerializers() {
             offset += sizeof(float) * 2;
             uint8_t can_collide_byte = rb.can_collide ? 1 : 0;
             data[offset] = can_collide_byte;
+            offset += 1;
+            data[offset] = rb.is_static ? 1 : 0;
+            offset += 1;
+            std::memcpy(data.data() + offset, &rb.layer, sizeof(uint32_t));
+            offset += sizeof(uint32_t);
+            std::memcpy(data.data() + offset, &rb.mask, sizeof(uint32_t));
+            offset += sizeof(uint32_t);
+            data[offset] = rb.is_trigger ? 1 : 0;
             return data;
         },
         [](const uint8_t *data, size_t size) -> rigidbody {
@@ -77,6 +86,7 @@ void InitializeComponentSerializers() {
             rb.base_size[0] = 0.0f;
             rb.base_size[1] = 0.0f;
             rb.can_collide = false;
+            rb.is_static = false;
             rb.Hitbox = sf::RectangleShape({0.0f, 0.0f});
             
             // Expect: velocity (2 floats) + Mass (1 float) + base_size (2 floats) + can_collide (1 byte)
@@ -89,6 +99,20 @@ void InitializeComponentSerializers() {
                 std::memcpy(rb.base_size, data + offset, sizeof(float) * 2);
                 offset += sizeof(float) * 2;
                 rb.can_collide = (data[offset] != 0);
+                offset += 1;
+                // Older senders don't include is_static
+                if (size >= sizeof(float) * 5 + 2) {
+                    rb.is_static = (data[offset] != 0);
+                    offset += 1;
+                }
+                // ...nor collision layers
+                if (size >= sizeof(float) * 5 + 2 + sizeof(uint32_t) * 2 + 1) {
+                    std::memcpy(&rb.layer, data + offset, sizeof(uint32_t));
+                    offset += sizeof(uint32_t);
+                    std::memcpy(&rb.mask, data + offset, sizeof(uint32_t));
+                    offset += sizeof(uint32_t);
+                    rb.is_trigger = (data[offset] != 0);
+                }
                 // Hitbox will be reconstructed from base_size
                 rb.Hitbox = sf::RectangleShape({rb.base_size[0], rb.base_size[1]});
             }
@@ -5,17 +5,54 @@
 #include <cstdint>
 #include <memory>
 
-void conductor::init() {
-    // Create pointers to each manager
-    m_component_manager = std::make_unique<component_manager>();
-    m_entity_manager = std::make_unique<entity_manager>();
+void conductor::init(storage_mode mode, entity initial_capacity) {
+    // Create pointers to each manager, the component manager using the
+    // requested storage layout and the entity manager reserving room for
+    // the expected entity count (it grows past it on demand)
+    m_component_manager = std::make_unique<component_manager>(mode);
+    m_entity_manager = std::make_unique<entity_manager>(initial_capacity);
     m_system_manager = std::make_unique<system_manager>();
 }
 
 // Entity methods
 entity conductor::create_entity() { return m_entity_manager->create_entity(); }
 
+entity conductor::create_entity(const entity_builder &builder) {
+    signature entity_signature = builder.build_signature(*m_component_manager);
+
+    entity ent = m_entity_manager->create_entity();
+    m_entity_manager->set_signature(ent, entity_signature);
+    m_component_manager->prepare_entity(ent, entity_signature);
+    builder.place(*m_component_manager, ent);
+
+    m_system_manager->entity_signature_changed(ent, entity_signature);
+    return ent;
+}
+
+std::vector<entity> conductor::create_entities(std::size_t count, const entity_builder &prototype) {
+    // Every copy shares the prototype's signature, so it is computed once
+    signature entity_signature = prototype.build_signature(*m_component_manager);
+
+    std::vector<entity> created;
+    created.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        entity ent = m_entity_manager->create_entity();
+        m_entity_manager->set_signature(ent, entity_signature);
+        m_component_manager->prepare_entity(ent, entity_signature);
+        prototype.place(*m_component_manager, ent);
+        created.push_back(ent);
+    }
+
+    m_system_manager->entities_signature_changed(created, entity_signature);
+    return created;
+}
+
 void conductor::destroy_entity(entity entity) {
+    // Stale handles (already destroyed) are ignored
+    if (!is_alive(entity)) {
+        return;
+    }
+
     // If this is a networked entity, unregister it from NetworkManager
     if (has_component<network>(entity)) {
         NetworkManager::Get().UnregisterNetworkEntity(entity);
@@ -26,6 +63,29 @@ void conductor::destroy_entity(entity entity) {
     m_system_manager->entity_destroyed(entity);
 }
 
+void conductor::destroy_entities(const std::vector<entity> &entities) {
+    std::vector<entity> destroyed;
+    destroyed.reserve(entities.size());
+    for (entity ent : entities) {
+        // Skip stale handles and duplicates already destroyed in this batch
+        if (!is_alive(ent)) {
+            continue;
+        }
+        if (has_component<network>(ent)) {
+            NetworkManager::Get().UnregisterNetworkEntity(ent);
+        }
+        m_entity_manager->destroy_entity(ent);
+        m_component_manager->entity_destroyed(ent);
+        destroyed.push_back(ent);
+    }
+
+    m_system_manager->entities_destroyed(destroyed);
+}
+
+bool conductor::is_alive(entity entity) const { return m_entity_manager->is_alive(entity); }
+
+signature conductor::get_signature(entity entity) const { return m_entity_manager->get_signature(entity); }
+
 // Special case for creating a networked entity
 // This is used to create a networked entity with a given network ID and local flag
 // The network ID is used to identify the entity on the network
@@ -49,3 +109,19 @@ entity conductor::create_networked_entity(uint32_t network_id, bool is_local) {
 
     return ent;
 }
+
+// Networked entity built in one step - the network component is staged with
+// the others so systems see the complete entity straight away
+entity conductor::create_networked_entity(uint32_t network_id, bool is_local, entity_builder builder) {
+    network net_comp;
+    net_comp.id = network_id;
+    net_comp.is_local = is_local;
+    builder.with(net_comp);
+
+    entity ent = create_entity(builder);
+
+    // Register with NetworkManager
+    NetworkManager::Get().RegisterNetworkEntity(network_id, ent);
+
+    return ent;
+}
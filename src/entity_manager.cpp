@@ -1,28 +1,51 @@
 #include "entity_manager.hpp"
+#include <cassert>
+#include <stdexcept>
 
-entity_manager::entity_manager() {
-    for (entity i = 0; i < MAX_ENTITIES; i++) {
-        available_entities.push(i); // Add all entities to the available entities queue
-    }
+entity_manager::entity_manager(entity initial_capacity) {
+    // Reserve up front; indices are handed out lazily and storage grows past this if needed
+    signatures.reserve(initial_capacity);
+    generations.reserve(initial_capacity);
 }
 
 entity entity_manager::create_entity() {
-    entity id = available_entities.front(); // Get the first available entity
-    available_entities.pop(); // Remove the entity from the available entities queue
+    entity index;
+    // Once every index has been handed out, reuse destroyed ones even if few are free
+    if (available_entities.size() > MIN_FREE_INDICES ||
+        (generations.size() >= MAX_ENTITIES && !available_entities.empty())) {
+        index = available_entities.front(); // Reuse the oldest destroyed index
+        available_entities.pop(); // Remove the index from the available entities queue
+    } else {
+        if (generations.size() >= MAX_ENTITIES) {
+            throw std::length_error("Too many entities in existence.");
+        }
+        index = static_cast<entity>(generations.size()); // Grow by one fresh index
+        generations.push_back(0);
+        signatures.emplace_back();
+    }
     living_entity_count++; // Increment the living entity count
-    return id;
+    return make_entity(index, generations[index]);
 }
 
 void entity_manager::destroy_entity(entity entity) {
-    signatures[entity].reset(); // Reset the signature
-    available_entities.push(entity); // Add the entity to the available entities queue
+    assert(is_alive(entity) && "Destroying an entity that is not alive.");
+    ::entity index = entity_index(entity);
+    signatures[index].reset(); // Reset the signature
+    // Bump the generation so existing handles to this index become stale
+    generations[index] = (generations[index] + 1) & (ENTITY_GENERATION_MASK >> ENTITY_INDEX_BITS);
+    available_entities.push(index); // Add the index to the available entities queue
     living_entity_count--; // Decrement the living entity count
 }
 
+bool entity_manager::is_alive(entity entity) const {
+    ::entity index = entity_index(entity);
+    return index < generations.size() && generations[index] == entity_generation(entity);
+}
+
 signature entity_manager::get_signature(entity entity) {
-    return signatures[entity]; // Return the signature for the entity
+    return signatures[entity_index(entity)]; // Return the signature for the entity
 }
 
 void entity_manager::set_signature(entity entity, signature signature) {
-    signatures[entity] = signature; // Set the signature for the entity
-}
\ No newline at end of file
+    signatures[entity_index(entity)] = signature; // Set the signature for the entity
+}
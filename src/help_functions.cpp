@@ -1,6 +1,116 @@
 #include "help_functions.hpp"
+#include <algorithm>
+#include <limits>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
 
 bool rectanglesIntersect(float x1, float y1, float w1, float h1,
     float x2, float y2, float w2, float h2) {
     return x1 < x2 + w2 && x1 + w1 > x2 && y1 < y2 + h2 && y1 + h1 > y2;
-}
\ No newline at end of file
+}
+
+namespace {
+// Fractions of a move along one axis at which the intervals start and stop
+// overlapping. Returns false if they never overlap
+bool sweepInterval(float min1, float size1, float move, float min2, float size2, float& entry, float& exit) {
+    if (move > 0.0f) {
+        entry = (min2 - (min1 + size1)) / move;
+        exit = ((min2 + size2) - min1) / move;
+    } else if (move < 0.0f) {
+        entry = ((min2 + size2) - min1) / move;
+        exit = (min2 - (min1 + size1)) / move;
+    } else {
+        // Not moving on this axis - overlapping throughout or never
+        entry = -std::numeric_limits<float>::infinity();
+        exit = std::numeric_limits<float>::infinity();
+        return min1 < min2 + size2 && min1 + size1 > min2;
+    }
+    return true;
+}
+
+// Append the index of every set bit of mask, offset by base
+void appendHits(std::uint32_t mask, std::uint32_t base, std::vector<std::uint32_t>& hits) {
+    for (std::uint32_t bit = 0; mask != 0; ++bit, mask >>= 1) {
+        if (mask & 1u) {
+            hits.push_back(base + bit);
+        }
+    }
+}
+} // namespace
+
+bool sweptRectanglesHit(float x1, float y1, float w1, float h1, float dx, float dy,
+    float x2, float y2, float w2, float h2, float& time, int& axis) {
+    // Already overlapping is left to the discrete test
+    if (rectanglesIntersect(x1, y1, w1, h1, x2, y2, w2, h2)) {
+        return false;
+    }
+    float entryX, exitX, entryY, exitY;
+    if (!sweepInterval(x1, w1, dx, x2, w2, entryX, exitX) || !sweepInterval(y1, h1, dy, y2, h2, entryY, exitY)) {
+        return false;
+    }
+
+    // They overlap once both axes do, until either stops
+    float entry = std::max(entryX, entryY);
+    float exit = std::min(exitX, exitY);
+    if (entry >= exit || entry < 0.0f || entry > 1.0f) {
+        return false;
+    }
+    time = entry;
+    axis = entryX > entryY ? 0 : 1;
+    return true;
+}
+
+void rectanglesIntersectBatch(float x, float y, float w, float h,
+    const rectangle_batch& batch, std::vector<std::uint32_t>& hits) {
+    const std::size_t count = batch.size();
+    const float* bx = batch.x.data();
+    const float* by = batch.y.data();
+    const float* bw = batch.w.data();
+    const float* bh = batch.h.data();
+    // Far edges of the tested rectangle, computed once like the scalar test does per pair
+    const float right = x + w;
+    const float bottom = y + h;
+    std::size_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256 x8 = _mm256_set1_ps(x);
+    const __m256 y8 = _mm256_set1_ps(y);
+    const __m256 right8 = _mm256_set1_ps(right);
+    const __m256 bottom8 = _mm256_set1_ps(bottom);
+    for (; i + 8 <= count; i += 8) {
+        __m256 left2 = _mm256_loadu_ps(bx + i);
+        __m256 top2 = _mm256_loadu_ps(by + i);
+        __m256 right2 = _mm256_add_ps(left2, _mm256_loadu_ps(bw + i));
+        __m256 bottom2 = _mm256_add_ps(top2, _mm256_loadu_ps(bh + i));
+        __m256 overlap = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(x8, right2, _CMP_LT_OQ), _mm256_cmp_ps(right8, left2, _CMP_GT_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(y8, bottom2, _CMP_LT_OQ), _mm256_cmp_ps(bottom8, top2, _CMP_GT_OQ)));
+        appendHits(static_cast<std::uint32_t>(_mm256_movemask_ps(overlap)), static_cast<std::uint32_t>(i), hits);
+    }
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+    const __m128 x4 = _mm_set1_ps(x);
+    const __m128 y4 = _mm_set1_ps(y);
+    const __m128 right4 = _mm_set1_ps(right);
+    const __m128 bottom4 = _mm_set1_ps(bottom);
+    for (; i + 4 <= count; i += 4) {
+        __m128 left2 = _mm_loadu_ps(bx + i);
+        __m128 top2 = _mm_loadu_ps(by + i);
+        __m128 right2 = _mm_add_ps(left2, _mm_loadu_ps(bw + i));
+        __m128 bottom2 = _mm_add_ps(top2, _mm_loadu_ps(bh + i));
+        __m128 overlap = _mm_and_ps(_mm_and_ps(_mm_cmplt_ps(x4, right2), _mm_cmpgt_ps(right4, left2)),
+                                    _mm_and_ps(_mm_cmplt_ps(y4, bottom2), _mm_cmpgt_ps(bottom4, top2)));
+        appendHits(static_cast<std::uint32_t>(_mm_movemask_ps(overlap)), static_cast<std::uint32_t>(i), hits);
+    }
+#endif
+
+    // Remaining rectangles (all of them without SIMD)
+    for (; i < count; ++i) {
+        if (x < bx[i] + bw[i] && right > bx[i] && y < by[i] + bh[i] && bottom > by[i]) {
+            hits.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+}
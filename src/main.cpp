@@ -10,7 +10,9 @@
 #include "components/transform.hpp"
 #include "conductor.hpp"
 #include "entity.hpp"
+#include "entity_builder.hpp"
 #include "network_manager.hpp"
+#include "scheduler.hpp"
 #include "systems/basic_render_system.hpp"
 #include "systems/collision_detection_system.hpp"
 #include "systems/inventory_system.hpp"
@@ -58,6 +60,12 @@ void create_coin(network_system &network_system1,
                  const std::string &coin_texture_name,
                  const sf::Texture &coin_ui_texture,
                  const std::string &coin_ui_texture_name);
+entity_builder coin_builder(const sf::Texture &coin_texture,
+                            const std::string &coin_texture_name,
+                            const sf::Texture &coin_ui_texture,
+                            const std::string &coin_ui_texture_name);
+entity_builder player_builder(const sf::Texture &player_texture,
+                              const std::string &player_texture_name);
 
 void register_components() {
     g_conductor.register_component<transform>();
@@ -107,9 +115,11 @@ void register_signatures() {
     g_conductor.set_system_signature<collision_detection_system>(
         collision_detection_system_signature);
 
-    // Set the signature for the physics system (uses rigidbody and gravity
-    // components)
+    // Set the signature for the physics system (uses transform, rigidbody and
+    // gravity components)
     signature physics_system_signature;
+    physics_system_signature.set(g_conductor.get_component_type<transform>(),
+                                 true);
     physics_system_signature.set(g_conductor.get_component_type<rigidbody>(),
                                  true);
     physics_system_signature.set(g_conductor.get_component_type<gravity>(),
@@ -181,6 +191,10 @@ int main() {
 
     register_signatures();
 
+    // Most bodies rest between frames, which sweep-and-prune exploits
+    collision_detection_system1->set_broad_phase(
+        broad_phase_mode::sweep_and_prune);
+
     // Wire up network packet callback
     NetworkManager::Get().SetPacketCallback(
         [&network_system1](HSteamNetConnection conn, const void *data,
@@ -218,12 +232,14 @@ int main() {
     auto ground = g_conductor.create_entity();
     g_conductor.add_component<transform>(
         ground, transform{{0.0f, 100.0f}, {0.0f, 100.0f}, {1.0f, 1.0f}});
-    g_conductor.add_component<rigidbody>(
-        ground, rigidbody{{0.0f, 0.0f},
+    rigidbody ground_body{{0.0f, 0.0f},
                           2000.0f,
                           sf::RectangleShape({1280.0f, 32.0f}),
                           true,
-                          {1280.0f, 32.0f}});
+                          {1280.0f, 32.0f},
+                          true};
+    ground_body.layer = LAYER_WORLD;
+    g_conductor.add_component<rigidbody>(ground, ground_body);
 
     // Create sprite component with texture first, then create sprite from component's texture
     auto ground_texture_name = "assets/images/big_ground.png";
@@ -284,6 +300,69 @@ int main() {
     bool j_is_pressed = false;
     bool c_is_pressed = false;
     bool c_was_pressed = false;
+    bool f1_is_pressed = false;
+    bool f1_was_pressed = false;
+    bool show_hitboxes = false;
+
+    // Per-frame simulation steps in program order, with the components each
+    // one reads and writes. Steps that don't conflict run concurrently; input
+    // and networking talk to the outside world, so they run alone on the main
+    // thread.
+    scheduler frame_scheduler;
+    frame_scheduler.add(
+        "player_input",
+        {g_conductor.make_signature<player, network, entity_state>(),
+         g_conductor.make_signature<transform, rigidbody, jump, inventory,
+                                    item, entity_state>(),
+         true},
+        [&](float) {
+            if (has_focus) {
+                player_input_system1->update(
+                    *inventory_system1, *item_system1,
+                    space_was_pressed); // Process player input
+            }
+        });
+    frame_scheduler.add(
+        "physics",
+        {g_conductor.make_signature<gravity, network, entity_state>(),
+         g_conductor.make_signature<transform, rigidbody>()},
+        [&](float dt) {
+            // Simulate physics and forces
+            physics_system1->update(dt, &frame_scheduler.pool());
+        });
+    frame_scheduler.add("item_timers",
+                        {signature(),
+                         g_conductor.make_signature<item, entity_state>()},
+                        [&](float dt) { item_system1->update(dt); });
+    frame_scheduler.add(
+        "collision",
+        {g_conductor.make_signature<entity_state>(),
+         g_conductor.make_signature<transform, rigidbody>()},
+        [&](float) {
+            // Run collision detection and resolve collisions (testing pairs
+            // in parallel), publishing this frame's contact events
+            collision_detection_system1->update(&frame_scheduler.pool());
+        });
+    frame_scheduler.add("landing",
+                        {g_conductor.make_signature<rigidbody, entity_state>(),
+                         g_conductor.make_signature<jump>()},
+                        [&](float) {
+                            // Let entities that landed jump again
+                            jump_system1->update(*collision_detection_system1);
+                        });
+    frame_scheduler.add(
+        "pickups",
+        {g_conductor.make_signature<transform, rigidbody>(),
+         g_conductor.make_signature<inventory, item, entity_state>()},
+        [&](float) {
+            inventory_system1->attempt_pickups(*item_system1,
+                                               *collision_detection_system1);
+        });
+    frame_scheduler.add("network", {signature(), signature(), true},
+                        [&](float dt) {
+                            // Send/receive network updates
+                            network_system1->update(dt);
+                        });
 
     // Main loop
     while (window.isOpen()) {
@@ -310,6 +389,12 @@ int main() {
             j_is_pressed = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::J);
             c_was_pressed = c_is_pressed;
             c_is_pressed = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::C);
+            f1_was_pressed = f1_is_pressed;
+            f1_is_pressed = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::F1);
+            // F1 toggles the collision debug overlay
+            if (f1_is_pressed && !f1_was_pressed) {
+                show_hitboxes = !show_hitboxes;
+            }
         }
 
         NetworkManager::Get().Update(); // Process network events
@@ -338,42 +423,12 @@ int main() {
                     // Create host player entity immediately
                     std::cout << "Creating host player with ID: " << host_id
                               << std::endl;
-                    entity player_entity =
-                        g_conductor.create_networked_entity(host_id, true);
+                    // Spawn with all player components in one step
+                    entity player_entity = g_conductor.create_networked_entity(
+                        host_id, true,
+                        player_builder(player_texture, player_texture_name));
                     local_player = player_entity;
 
-                    // Add all player components
-                    g_conductor.add_component<transform>(
-                        player_entity,
-                        transform{{0.0f, 0.0f}, {0.0f, 0.0f}, {1.0f, 1.0f}});
-                    g_conductor.add_component<player>(player_entity, player{});
-                    g_conductor.add_component<rigidbody>(
-                        player_entity,
-                        rigidbody{{0.0f, 0.0f},
-                                  100.0f,
-                                  sf::RectangleShape({32.0f, 48.0f}),
-                                  true,
-                                  {32.0f, 48.0f}});
-                    g_conductor.add_component<gravity>(player_entity,
-                                                       gravity{GRAVITY});
-                    g_conductor.add_component<jump>(player_entity,
-                                                    jump{-1000.0f, false});
-
-                    // Add sprite component
-                    sprite player_sprite_comp;
-                    player_sprite_comp.texture = player_texture;
-                    player_sprite_comp.texture_name = player_texture_name;
-                    player_sprite_comp.sprite_obj =
-                        sf::Sprite(player_sprite_comp.texture);
-                    g_conductor.add_component<sprite>(player_entity,
-                                                      player_sprite_comp);
-
-                    g_conductor.add_component<inventory>(
-                        player_entity,
-                        inventory{0, std::vector<entity>(), 0, 3});
-                    g_conductor.add_component<entity_state>(
-                        player_entity, entity_state{true, false});
-
                     // Configure network component - specify which components to sync continuously
                     auto &net_comp = g_conductor.get_component<network>(player_entity);
                     net_comp.networked_components = {ComponentID::Transform, ComponentID::Rigidbody};
@@ -409,63 +464,13 @@ int main() {
                           << std::endl;
 
                 try {
-                    // Create networked player entity
+                    // Create networked player entity with all its components
                     std::cout << "  - Creating entity..." << std::endl;
-                    entity player_entity =
-                        g_conductor.create_networked_entity(granted_id, true);
+                    entity player_entity = g_conductor.create_networked_entity(
+                        granted_id, true,
+                        player_builder(player_texture, player_texture_name));
                     local_player = player_entity;
 
-                    // Add transform component
-                    std::cout << "  - Adding transform..." << std::endl;
-                    g_conductor.add_component<transform>(
-                        player_entity,
-                        transform{{0.0f, 0.0f}, {0.0f, 0.0f}, {1.0f, 1.0f}});
-
-                    // Add player marker component
-                    std::cout << "  - Adding player..." << std::endl;
-                    g_conductor.add_component<player>(player_entity, player{});
-
-                    // Add rigidbody component
-                    std::cout << "  - Adding rigidbody..." << std::endl;
-                    g_conductor.add_component<rigidbody>(
-                        player_entity,
-                        rigidbody{{0.0f, 0.0f},
-                                  100.0f,
-                                  sf::RectangleShape({32.0f, 48.0f}),
-                                  true,
-                                  {32.0f, 48.0f}});
-
-                    // Add gravity component
-                    std::cout << "  - Adding gravity..." << std::endl;
-                    g_conductor.add_component<gravity>(player_entity,
-                                                       gravity{GRAVITY});
-
-                    // Add jump component
-                    std::cout << "  - Adding jump..." << std::endl;
-                    g_conductor.add_component<jump>(player_entity,
-                                                    jump{-1000.0f, false});
-
-                    // Add sprite component
-                    std::cout << "  - Adding sprite..." << std::endl;
-                    sprite player_sprite_comp;
-                    player_sprite_comp.texture = player_texture;
-                    player_sprite_comp.texture_name = player_texture_name;
-                    player_sprite_comp.sprite_obj =
-                        sf::Sprite(player_sprite_comp.texture);
-                    g_conductor.add_component<sprite>(player_entity,
-                                                      player_sprite_comp);
-
-                    // Add inventory component
-                    std::cout << "  - Adding inventory..." << std::endl;
-                    g_conductor.add_component<inventory>(
-                        player_entity,
-                        inventory{0, std::vector<entity>(), 0, 3});
-
-                    // Add entity state component
-                    std::cout << "  - Adding entity_state..." << std::endl;
-                    g_conductor.add_component<entity_state>(
-                        player_entity, entity_state{true, false});
-
                     // Configure network component - specify which components to sync continuously
                     std::cout << "  - Configuring network sync..." << std::endl;
                     auto &net_comp = g_conductor.get_component<network>(player_entity);
@@ -522,46 +527,11 @@ int main() {
 
                 std::cout << "Received network ID " << granted_id << " for coin, creating..." << std::endl;
 
-                // Create the networked entity with the granted ID
-                auto item_entity = g_conductor.create_networked_entity(granted_id, true);
-
-                // Add transform component
-                g_conductor.add_component<transform>(
-                    item_entity,
-                    transform{{200.0f, -200.0f}, {200.0f, -200.0f}, {1.0f, 1.0f}});
-
-                // Add rigidbody component
-                g_conductor.add_component<rigidbody>(
-                    item_entity, rigidbody{{0.0f, -200.0f},
-                                           20.0f,
-                                           sf::RectangleShape({8.0f, 8.0f}),
-                                           true,
-                                           {8.0f, 8.0f}});
-
-                // Add gravity component
-                g_conductor.add_component<gravity>(item_entity, gravity{GRAVITY});
-
-                // Create sprite for world rendering using persistent texture reference
-                sprite item_sprite_comp;
-                item_sprite_comp.texture = coin_texture;
-                item_sprite_comp.texture_name = coin_texture_name;
-                item_sprite_comp.sprite_obj = sf::Sprite(item_sprite_comp.texture);
-                g_conductor.add_component<sprite>(item_entity, item_sprite_comp);
-
-                // Create UI view sprite using persistent texture reference
-                sprite item_ui_view_sprite;
-                item_ui_view_sprite.texture = coin_ui_texture;
-                item_ui_view_sprite.texture_name = coin_ui_texture_name;
-                item_ui_view_sprite.sprite_obj = sf::Sprite(item_ui_view_sprite.texture);
-
-                // Add item component with UI sprite
-                g_conductor.add_component<item>(
-                    item_entity,
-                    item{item_ui_view_sprite.sprite_obj.value(), false, 0, -1, true});
-
-                // Add entity state component
-                g_conductor.add_component<entity_state>(item_entity,
-                                                        entity_state{true, false});
+                // Create the networked coin with the granted ID in one step
+                auto item_entity = g_conductor.create_networked_entity(
+                    granted_id, true,
+                    coin_builder(coin_texture, coin_texture_name,
+                                 coin_ui_texture, coin_ui_texture_name));
 
                 // Configure network component
                 auto &net_comp = g_conductor.get_component<network>(item_entity);
@@ -575,23 +545,12 @@ int main() {
 
             entity player_entity = local_player.value();
 
-            if (has_focus) {
-                player_input_system1->update(
-                    *inventory_system1, *item_system1,
-                    space_was_pressed); // Process player input
-            }
-
-            physics_system1->update(dt); // Simulate physics and forces
-
-            item_system1->update(dt);
-            inventory_system1->attempt_pickups(*item_system1);
+            // Input, physics, items, pickups, collision and networking
+            frame_scheduler.run(dt);
 
-            collision_detection_system1->update(
-                *jump_system1); // Run collision detection and resolve
-                                // collisions
-
-            // Network System - send/receive network updates
-            network_system1->update(dt);
+            // Sync point - apply structural changes recorded by the systems
+            // and network handlers this frame, before anything is rendered
+            g_conductor.flush_commands();
 
             // Update camera view BEFORE rendering so rendering uses the correct
             // view
@@ -602,6 +561,9 @@ int main() {
             window.setView(view);
 
             basic_render_system1->update(window);
+            if (show_hitboxes) {
+                basic_render_system1->draw_hitboxes(window);
+            }
 
             /*******************************************
              *                                         *
@@ -679,31 +641,52 @@ void create_coin(network_system &network_system1,
     // Host allocates its own network ID directly
     uint32_t network_id = NetworkManager::Get().AllocateNetworkId();
 
-    // Create the networked entity (this already adds the network component)
-    auto item_entity = g_conductor.create_networked_entity(network_id, true);
+    // Create the networked entity with all coin components (and the network
+    // component) in one step, so systems pick it up with a single update
+    auto item_entity = g_conductor.create_networked_entity(
+        network_id, true,
+        coin_builder(coin_texture, coin_texture_name, coin_ui_texture,
+                     coin_ui_texture_name));
 
-    // Add transform component
-    g_conductor.add_component<transform>(
-        item_entity,
-        transform{{200.0f, -200.0f}, {200.0f, -200.0f}, {1.0f, 1.0f}});
+    // Configure network component (added by create_networked_entity)
+    // Specify which components should be synced over the network
+    auto &net_comp = g_conductor.get_component<network>(item_entity);
+    net_comp.networked_components = {ComponentID::Transform, ComponentID::Rigidbody, ComponentID::Item, ComponentID::Sprite};
 
-    // Add rigidbody component
-    g_conductor.add_component<rigidbody>(
-        item_entity, rigidbody{{0.0f, -200.0f},
-                               20.0f,
-                               sf::RectangleShape({8.0f, 8.0f}),
-                               true,
-                               {8.0f, 8.0f}});
+    std::cout << "Created coin entity with network ID: " << network_id << std::endl;
 
-    // Add gravity component
-    g_conductor.add_component<gravity>(item_entity, gravity{GRAVITY});
+    // Broadcast the entity to all clients (if host)
+    if (NetworkManager::Get().IsHost()) {
+        network_system1.send_entity_init(item_entity);
+        std::cout << "Broadcasted coin entity to all clients" << std::endl;
+    }
+}
+
+// Stage the components of a coin (everything except the network component)
+entity_builder coin_builder(const sf::Texture &coin_texture,
+                            const std::string &coin_texture_name,
+                            const sf::Texture &coin_ui_texture,
+                            const std::string &coin_ui_texture_name) {
+    entity_builder builder;
+
+    builder.with(transform{{200.0f, -200.0f}, {200.0f, -200.0f}, {1.0f, 1.0f}});
+    rigidbody coin_body{{0.0f, -200.0f},
+                        20.0f,
+                        sf::RectangleShape({8.0f, 8.0f}),
+                        true,
+                        {8.0f, 8.0f}};
+    // Coins land on the ground and get picked up, but don't stack on each other
+    coin_body.layer = LAYER_ITEM;
+    coin_body.mask = LAYER_ALL & ~LAYER_ITEM;
+    builder.with(coin_body);
+    builder.with(gravity{GRAVITY});
 
     // Create sprite for world rendering using persistent texture reference
     sprite item_sprite_comp;
     item_sprite_comp.texture = coin_texture;
     item_sprite_comp.texture_name = coin_texture_name;
     item_sprite_comp.sprite_obj = sf::Sprite(item_sprite_comp.texture);
-    g_conductor.add_component<sprite>(item_entity, item_sprite_comp);
+    builder.with(item_sprite_comp);
 
     // Create UI view sprite using persistent texture reference
     sprite item_ui_view_sprite;
@@ -711,25 +694,36 @@ void create_coin(network_system &network_system1,
     item_ui_view_sprite.texture_name = coin_ui_texture_name;
     item_ui_view_sprite.sprite_obj = sf::Sprite(item_ui_view_sprite.texture);
 
-    // Add item component with UI sprite
-    g_conductor.add_component<item>(
-        item_entity,
-        item{item_ui_view_sprite.sprite_obj.value(), false, 0, -1, true});
-
-    // Add entity state component
-    g_conductor.add_component<entity_state>(item_entity,
-                                            entity_state{true, false});
-
-    // Configure network component (already added by create_networked_entity)
-    // Specify which components should be synced over the network
-    auto &net_comp = g_conductor.get_component<network>(item_entity);
-    net_comp.networked_components = {ComponentID::Transform, ComponentID::Rigidbody, ComponentID::Item, ComponentID::Sprite};
+    // Item component with UI sprite
+    builder.with(item{item_ui_view_sprite.sprite_obj.value(), false, 0, -1, true});
+    builder.with(entity_state{true, false});
+    return builder;
+}
 
-    std::cout << "Created coin entity with network ID: " << network_id << std::endl;
+// Stage the components of a player (everything except the network component)
+entity_builder player_builder(const sf::Texture &player_texture,
+                              const std::string &player_texture_name) {
+    entity_builder builder;
 
-    // Broadcast the entity to all clients (if host)
-    if (NetworkManager::Get().IsHost()) {
-        network_system1.send_entity_init(item_entity);
-        std::cout << "Broadcasted coin entity to all clients" << std::endl;
-    }
-}
\ No newline at end of file
+    builder.with(transform{{0.0f, 0.0f}, {0.0f, 0.0f}, {1.0f, 1.0f}});
+    builder.with(player{});
+    rigidbody player_body{{0.0f, 0.0f},
+                          100.0f,
+                          sf::RectangleShape({32.0f, 48.0f}),
+                          true,
+                          {32.0f, 48.0f}};
+    player_body.layer = LAYER_PLAYER;
+    builder.with(player_body);
+    builder.with(gravity{GRAVITY});
+    builder.with(jump{-1000.0f, false});
+
+    sprite player_sprite_comp;
+    player_sprite_comp.texture = player_texture;
+    player_sprite_comp.texture_name = player_texture_name;
+    player_sprite_comp.sprite_obj = sf::Sprite(player_sprite_comp.texture);
+    builder.with(player_sprite_comp);
+
+    builder.with(inventory{0, std::vector<entity>(), 0, 3});
+    builder.with(entity_state{true, false});
+    return builder;
+}
@@ -2,6 +2,7 @@
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <steam/isteamnetworkingsockets.h>
 #include <steam/steamclientpublic.h>
@@ -9,6 +10,9 @@
 #include <steam/steamnetworkingtypes.h>
 #include <string>
 
+// Network IDs at or above this are rejected, which bounds the ID table
+constexpr uint32_t MAX_NETWORK_ID = 1u << 24;
+
 NetworkManager &NetworkManager::Get() {
     static NetworkManager instance;
     return instance;
@@ -30,6 +34,10 @@ bool NetworkManager::Init() {
 }
 
 void NetworkManager::Shutdown() {
+    for (SteamNetworkingMessage_t *message : m_outgoingMessages) {
+        message->Release();
+    }
+    m_outgoingMessages.clear();
     if (m_hListenSocket != k_HSteamListenSocket_Invalid) {
         m_pInterface->CloseListenSocket(m_hListenSocket);
         m_hListenSocket = k_HSteamListenSocket_Invalid;
@@ -168,6 +176,8 @@ bool NetworkManager::Connect(const std::string &address) {
 
 void NetworkManager::Update() {
     PollIncomingMessages();
+    // Send what the packet callbacks queued (e.g. updates the host forwards)
+    FlushMessages();
     m_pInterface->RunCallbacks();
 }
 
@@ -243,25 +253,52 @@ uint32_t NetworkManager::AllocateNetworkId() {
 }
 
 void NetworkManager::RegisterNetworkEntity(uint32_t netId, entity ent) {
+    if (netId == 0 || netId >= MAX_NETWORK_ID) {
+        std::cerr << "Invalid network ID: " << netId << std::endl;
+        return;
+    }
+    UnregisterNetworkEntity(ent);
+
+    if (netId >= m_networkIdToEntity.size()) {
+        m_networkIdToEntity.resize(netId + 1, NULL_ENTITY);
+    }
+    // The ID moves to this entity
+    entity previous = m_networkIdToEntity[netId];
+    if (previous != NULL_ENTITY && m_entityToNetworkId[entity_index(previous)] == netId) {
+        m_entityToNetworkId[entity_index(previous)] = 0;
+    }
     m_networkIdToEntity[netId] = ent;
+
+    entity index = entity_index(ent);
+    if (index >= m_entityToNetworkId.size()) {
+        m_entityToNetworkId.resize(index + 1, 0);
+    }
+    m_entityToNetworkId[index] = netId;
 }
 
 void NetworkManager::UnregisterNetworkEntity(entity ent) {
-    // Find and remove the network ID mapping for this entity
-    for (auto it = m_networkIdToEntity.begin(); it != m_networkIdToEntity.end(); ++it) {
-        if (it->second == ent) {
-            m_networkIdToEntity.erase(it);
-            return;
-        }
-    }
+    uint32_t netId = GetNetworkIdByEntity(ent);
+    if (netId == 0)
+        return;
+    m_networkIdToEntity[netId] = NULL_ENTITY;
+    m_entityToNetworkId[entity_index(ent)] = 0;
 }
 
 entity NetworkManager::GetEntityByNetworkId(uint32_t netId) const {
-    auto it = m_networkIdToEntity.find(netId);
-    if (it != m_networkIdToEntity.end()) {
-        return it->second;
-    }
-    return 0; // Invalid entity
+    if (netId >= m_networkIdToEntity.size())
+        return NULL_ENTITY;
+    return m_networkIdToEntity[netId];
+}
+
+uint32_t NetworkManager::GetNetworkIdByEntity(entity ent) const {
+    entity index = entity_index(ent);
+    if (index >= m_entityToNetworkId.size())
+        return 0;
+    // The slot may belong to an earlier entity with the same index
+    uint32_t netId = m_entityToNetworkId[index];
+    if (netId == 0 || m_networkIdToEntity[netId] != ent)
+        return 0;
+    return netId;
 }
 
 HSteamNetConnection
@@ -280,4 +317,37 @@ void NetworkManager::SendToConnection(HSteamNetConnection conn,
         return;
     m_pInterface->SendMessageToConnection(conn, data, size, nSendFlags,
                                           nullptr);
-}
\ No newline at end of file
+}
+
+void NetworkManager::QueueMessage(HSteamNetConnection conn, const void *data,
+                                  size_t size, int nSendFlags) {
+    if (conn == k_HSteamNetConnection_Invalid)
+        return;
+    SteamNetworkingMessage_t *message =
+        SteamNetworkingUtils()->AllocateMessage(static_cast<int>(size));
+    std::memcpy(message->m_pData, data, size);
+    message->m_conn = conn;
+    message->m_nFlags = nSendFlags;
+    m_outgoingMessages.push_back(message);
+}
+
+void NetworkManager::FlushMessages() {
+    if (m_outgoingMessages.empty())
+        return;
+    // The library takes ownership of the messages and releases them once sent
+    m_pInterface->SendMessages(static_cast<int>(m_outgoingMessages.size()),
+                               m_outgoingMessages.data(), nullptr);
+    m_outgoingMessages.clear();
+}
+
+std::vector<HSteamNetConnection> NetworkManager::GetPeerConnections() const {
+    std::vector<HSteamNetConnection> connections;
+    if (m_isHost) {
+        for (auto const &[conn, id] : m_clientConnections) {
+            connections.push_back(conn);
+        }
+    } else if (m_hConnection != k_HSteamNetConnection_Invalid) {
+        connections.push_back(m_hConnection);
+    }
+    return connections;
+}
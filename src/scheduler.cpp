@@ -0,0 +1,65 @@
+#include "scheduler.hpp"
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+scheduler::scheduler()
+    : scheduler(std::max(1u, std::thread::hardware_concurrency()) - 1) {}
+
+scheduler::scheduler(std::size_t worker_count) : m_pool(worker_count) {}
+
+void scheduler::add(std::string name, component_access access, step_function run) {
+    m_steps.push_back(step{std::move(name), access, std::move(run)});
+    m_stages_dirty = true;
+}
+
+void scheduler::run(float delta_time) {
+    if (m_stages_dirty) {
+        build_stages();
+    }
+
+    for (const auto &stage : m_stages) {
+        if (stage.size() == 1) {
+            // Single steps (including every exclusive one) stay on this thread
+            m_steps[stage.front()].run(delta_time);
+            continue;
+        }
+
+        std::vector<std::function<void()>> tasks;
+        tasks.reserve(stage.size());
+        for (std::size_t index : stage) {
+            tasks.emplace_back([this, index, delta_time]() { m_steps[index].run(delta_time); });
+        }
+        m_pool.run_all(tasks);
+    }
+}
+
+bool scheduler::conflicts(const component_access &a, const component_access &b) {
+    if (a.exclusive || b.exclusive) {
+        return true;
+    }
+    return (a.writes & (b.reads | b.writes)).any() || (b.writes & a.reads).any();
+}
+
+void scheduler::build_stages() {
+    // Each step goes one stage after the latest earlier step it conflicts with
+    std::vector<std::size_t> stage_of(m_steps.size(), 0);
+    m_stages.clear();
+
+    for (std::size_t i = 0; i < m_steps.size(); ++i) {
+        std::size_t stage = 0;
+        for (std::size_t j = 0; j < i; ++j) {
+            if (conflicts(m_steps[i].access, m_steps[j].access)) {
+                stage = std::max(stage, stage_of[j] + 1);
+            }
+        }
+        stage_of[i] = stage;
+
+        if (stage >= m_stages.size()) {
+            m_stages.resize(stage + 1);
+        }
+        m_stages[stage].push_back(i);
+    }
+
+    m_stages_dirty = false;
+}
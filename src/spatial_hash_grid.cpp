@@ -0,0 +1,89 @@
+#include "spatial_hash_grid.hpp"
+#include <algorithm>
+#include <cmath>
+
+spatial_hash_grid::spatial_hash_grid(float cell_size)
+    : m_cell_size(cell_size), m_inverse_cell_size(1.0f / cell_size) {}
+
+void spatial_hash_grid::begin_frame() {
+    for (auto &cell : m_used_cells) {
+        cell.boxes->clear();
+    }
+    m_used_cells.clear();
+    m_boxes.clear();
+}
+
+void spatial_hash_grid::insert(entity ent, float x, float y, float width, float height, bool moved,
+                               std::uint32_t layer, std::uint32_t mask) {
+    box added{ent,
+              x,
+              y,
+              x + width,
+              y + height,
+              cell_coordinate(x),
+              cell_coordinate(y),
+              cell_coordinate(x + width),
+              cell_coordinate(y + height),
+              moved,
+              layer,
+              mask};
+    std::uint32_t index = static_cast<std::uint32_t>(m_boxes.size());
+    m_boxes.push_back(added);
+
+    for (std::int32_t cy = added.cell_min_y; cy <= added.cell_max_y; ++cy) {
+        for (std::int32_t cx = added.cell_min_x; cx <= added.cell_max_x; ++cx) {
+            auto &cell = m_cells[cell_key(cx, cy)];
+            if (cell.empty()) {
+                m_used_cells.push_back(used_cell{cx, cy, &cell});
+            }
+            cell.push_back(index);
+        }
+    }
+}
+
+void spatial_hash_grid::collect_pairs(std::vector<entity_pair> &pairs) {
+    m_box_pairs.clear();
+
+    for (const auto &cell : m_used_cells) {
+        const std::vector<std::uint32_t> &indices = *cell.boxes;
+        for (std::size_t i = 0; i < indices.size(); ++i) {
+            const box &a = m_boxes[indices[i]];
+            for (std::size_t j = i + 1; j < indices.size(); ++j) {
+                const box &b = m_boxes[indices[j]];
+                if (!a.moved && !b.moved) {
+                    continue;
+                }
+                if (!layers_interact(a.layer, a.mask, b.layer, b.mask)) {
+                    continue;
+                }
+                if (a.min_x >= b.max_x || b.min_x >= a.max_x || a.min_y >= b.max_y || b.min_y >= a.max_y) {
+                    continue;
+                }
+                // Boxes sharing several cells meet in each of them; only the
+                // cell at the corner of their shared range reports the pair
+                if (cell.x != std::max(a.cell_min_x, b.cell_min_x) ||
+                    cell.y != std::max(a.cell_min_y, b.cell_min_y)) {
+                    continue;
+                }
+                m_box_pairs.emplace_back(indices[i], indices[j]);
+            }
+        }
+    }
+
+    // Report in insertion order so results don't depend on hash layout
+    std::sort(m_box_pairs.begin(), m_box_pairs.end());
+    pairs.clear();
+    pairs.reserve(m_box_pairs.size());
+    for (const auto &[first, second] : m_box_pairs) {
+        pairs.emplace_back(m_boxes[first].ent, m_boxes[second].ent);
+    }
+}
+
+std::int32_t spatial_hash_grid::cell_coordinate(float value) const {
+    return static_cast<std::int32_t>(std::floor(value * m_inverse_cell_size));
+}
+
+std::uint64_t spatial_hash_grid::cell_key(std::int32_t x, std::int32_t y) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) |
+           static_cast<std::uint32_t>(y);
+}
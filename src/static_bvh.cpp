@@ -0,0 +1,111 @@
+#include "static_bvh.hpp"
+#include <algorithm>
+#include <utility>
+
+void static_bvh::build(std::vector<box> boxes) {
+    m_boxes = std::move(boxes);
+    m_nodes.clear();
+    if (m_boxes.empty()) {
+        return;
+    }
+
+    // A binary tree with at least one box per leaf has fewer than 2n nodes
+    m_nodes.reserve(2 * m_boxes.size());
+    m_nodes.emplace_back();
+    build_node(0, 0, static_cast<std::uint32_t>(m_boxes.size()));
+}
+
+void static_bvh::clear() {
+    m_boxes.clear();
+    m_nodes.clear();
+}
+
+void static_bvh::build_node(std::uint32_t node_index, std::uint32_t first, std::uint32_t count) {
+    auto begin = m_boxes.begin() + first;
+    auto end = begin + count;
+
+    // Bounds of the boxes and of their centres
+    node bounds{begin->min_x, begin->min_y, begin->max_x, begin->max_y, first, count};
+    float centre_min_x = begin->min_x + begin->max_x;
+    float centre_max_x = centre_min_x;
+    float centre_min_y = begin->min_y + begin->max_y;
+    float centre_max_y = centre_min_y;
+    for (auto it = begin; it != end; ++it) {
+        bounds.min_x = std::min(bounds.min_x, it->min_x);
+        bounds.min_y = std::min(bounds.min_y, it->min_y);
+        bounds.max_x = std::max(bounds.max_x, it->max_x);
+        bounds.max_y = std::max(bounds.max_y, it->max_y);
+        // Centres are kept doubled, only their order matters
+        centre_min_x = std::min(centre_min_x, it->min_x + it->max_x);
+        centre_max_x = std::max(centre_max_x, it->min_x + it->max_x);
+        centre_min_y = std::min(centre_min_y, it->min_y + it->max_y);
+        centre_max_y = std::max(centre_max_y, it->min_y + it->max_y);
+    }
+    m_nodes[node_index] = bounds;
+    if (count <= MAX_LEAF_BOXES) {
+        return;
+    }
+
+    // Split at the median centre along the axis the centres spread most on
+    auto middle = begin + count / 2;
+    if (centre_max_x - centre_min_x >= centre_max_y - centre_min_y) {
+        std::nth_element(begin, middle, end, [](const box &a, const box &b) {
+            return a.min_x + a.max_x < b.min_x + b.max_x;
+        });
+    } else {
+        std::nth_element(begin, middle, end, [](const box &a, const box &b) {
+            return a.min_y + a.max_y < b.min_y + b.max_y;
+        });
+    }
+
+    std::uint32_t left = static_cast<std::uint32_t>(m_nodes.size());
+    m_nodes.emplace_back();
+    m_nodes.emplace_back();
+    m_nodes[node_index].first = left;
+    m_nodes[node_index].count = 0;
+
+    std::uint32_t left_count = count / 2;
+    build_node(left, first, left_count);
+    build_node(left + 1, first + left_count, count - left_count);
+}
+
+void static_bvh::query(float x, float y, float width, float height, std::uint32_t layer, std::uint32_t mask,
+                       std::vector<entity> &hits) const {
+    if (m_nodes.empty()) {
+        return;
+    }
+    float min_x = x;
+    float min_y = y;
+    float max_x = x + width;
+    float max_y = y + height;
+
+    // Depth is logarithmic in the box count thanks to the median split
+    std::uint32_t stack[64];
+    std::size_t depth = 0;
+    stack[depth++] = 0;
+    while (depth > 0) {
+        const node &current = m_nodes[stack[--depth]];
+        if (current.min_x >= max_x || min_x >= current.max_x || current.min_y >= max_y ||
+            min_y >= current.max_y) {
+            continue;
+        }
+
+        if (current.count == 0) {
+            stack[depth++] = current.first;
+            stack[depth++] = current.first + 1;
+            continue;
+        }
+
+        for (std::uint32_t i = current.first; i < current.first + current.count; ++i) {
+            const box &candidate = m_boxes[i];
+            if (candidate.min_x >= max_x || min_x >= candidate.max_x || candidate.min_y >= max_y ||
+                min_y >= candidate.max_y) {
+                continue;
+            }
+            if (!layers_interact(layer, mask, candidate.layer, candidate.mask)) {
+                continue;
+            }
+            hits.push_back(candidate.ent);
+        }
+    }
+}
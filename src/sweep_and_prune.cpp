@@ -0,0 +1,160 @@
+#include "sweep_and_prune.hpp"
+#include <algorithm>
+#include <utility>
+
+void sweep_and_prune::begin_frame() {
+    m_next_rank = 0;
+    for (proxy &p : m_proxies) {
+        p.seen = false;
+    }
+}
+
+void sweep_and_prune::insert(entity ent, float x, float y, float width, float height, bool moved,
+                             std::uint32_t layer, std::uint32_t mask) {
+    auto [it, added] = m_proxy_of.try_emplace(ent, 0);
+    if (added) {
+        std::uint32_t index;
+        if (!m_free_proxies.empty()) {
+            index = m_free_proxies.back();
+            m_free_proxies.pop_back();
+        } else {
+            index = static_cast<std::uint32_t>(m_proxies.size());
+            m_proxies.emplace_back();
+        }
+        it->second = index;
+
+        // New endpoints start at the end of each axis; the next sort walks them
+        // into place, adding their overlaps on the way
+        for (std::size_t axis = 0; axis < 2; ++axis) {
+            m_axes[axis].push_back(endpoint{0.0f, index, true});
+            m_axes[axis].push_back(endpoint{0.0f, index, false});
+        }
+    }
+
+    proxy &p = m_proxies[it->second];
+    p.ent = ent;
+    p.min = {x, y};
+    p.max = {x + width, y + height};
+    p.rank = m_next_rank++;
+    p.layer = layer;
+    p.mask = mask;
+    // A proxy that just joined counts as moved so its overlaps get resolved
+    p.moved = moved || added;
+    p.seen = true;
+    p.alive = true;
+}
+
+void sweep_and_prune::collect_pairs(std::vector<entity_pair> &pairs) {
+    remove_unseen();
+    sort_axis(0);
+    sort_axis(1);
+
+    m_ranked.clear();
+    for (std::uint64_t key : m_pairs) {
+        const proxy &a = m_proxies[static_cast<std::uint32_t>(key >> 32)];
+        const proxy &b = m_proxies[static_cast<std::uint32_t>(key)];
+        if (!a.moved && !b.moved) {
+            continue;
+        }
+        // Overlaps are tracked whatever the layers, so a body changing layers
+        // needs no repair
+        if (!layers_interact(a.layer, a.mask, b.layer, b.mask)) {
+            continue;
+        }
+        if (a.rank < b.rank) {
+            m_ranked.push_back({{a.rank, b.rank}, {a.ent, b.ent}});
+        } else {
+            m_ranked.push_back({{b.rank, a.rank}, {b.ent, a.ent}});
+        }
+    }
+    std::sort(m_ranked.begin(), m_ranked.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+
+    pairs.clear();
+    pairs.reserve(m_ranked.size());
+    for (const auto &ranked : m_ranked) {
+        pairs.push_back(ranked.second);
+    }
+}
+
+std::uint64_t sweep_and_prune::pair_key(std::uint32_t a, std::uint32_t b) {
+    if (a > b) {
+        std::swap(a, b);
+    }
+    return (static_cast<std::uint64_t>(a) << 32) | b;
+}
+
+bool sweep_and_prune::overlaps(const proxy &a, const proxy &b) const {
+    return a.min[0] < b.max[0] && b.min[0] < a.max[0] && a.min[1] < b.max[1] && b.min[1] < a.max[1];
+}
+
+void sweep_and_prune::remove_unseen() {
+    bool removed_any = false;
+    for (std::uint32_t index = 0; index < m_proxies.size(); ++index) {
+        proxy &p = m_proxies[index];
+        if (p.alive && !p.seen) {
+            p.alive = false;
+            m_proxy_of.erase(p.ent);
+            m_free_proxies.push_back(index);
+            removed_any = true;
+        }
+    }
+    if (!removed_any) {
+        return;
+    }
+
+    // End every overlap of a removed proxy
+    for (auto it = m_pairs.begin(); it != m_pairs.end();) {
+        const proxy &a = m_proxies[static_cast<std::uint32_t>(*it >> 32)];
+        const proxy &b = m_proxies[static_cast<std::uint32_t>(*it)];
+        if (!a.alive || !b.alive) {
+            it = m_pairs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (auto &axis : m_axes) {
+        axis.erase(std::remove_if(axis.begin(), axis.end(),
+                                  [this](const endpoint &e) { return !m_proxies[e.proxy].alive; }),
+                   axis.end());
+    }
+}
+
+void sweep_and_prune::sort_axis(std::size_t axis) {
+    std::vector<endpoint> &endpoints = m_axes[axis];
+    for (endpoint &e : endpoints) {
+        const proxy &p = m_proxies[e.proxy];
+        e.value = e.is_min ? p.min[axis] : p.max[axis];
+    }
+
+    for (std::size_t i = 1; i < endpoints.size(); ++i) {
+        endpoint moving = endpoints[i];
+        std::size_t j = i;
+        while (j > 0 && endpoint_less(moving, endpoints[j - 1])) {
+            const endpoint &passed = endpoints[j - 1];
+            if (moving.proxy != passed.proxy) {
+                if (moving.is_min && !passed.is_min) {
+                    // A start moved before another box's end - they may overlap now
+                    if (overlaps(m_proxies[moving.proxy], m_proxies[passed.proxy])) {
+                        add_pair(moving.proxy, passed.proxy);
+                    }
+                } else if (!moving.is_min && passed.is_min) {
+                    // An end moved before another box's start - they are apart
+                    remove_pair(moving.proxy, passed.proxy);
+                }
+            }
+            endpoints[j] = passed;
+            --j;
+        }
+        endpoints[j] = moving;
+    }
+}
+
+void sweep_and_prune::add_pair(std::uint32_t a, std::uint32_t b) {
+    m_pairs.insert(pair_key(a, b));
+}
+
+void sweep_and_prune::remove_pair(std::uint32_t a, std::uint32_t b) {
+    m_pairs.erase(pair_key(a, b));
+}
@@ -5,7 +5,7 @@
 void system_manager::entity_destroyed(entity entity)
 {
     // Erase a destroyed entity from all system lists
-    // mEntities is a set so no check needed
+    // entities is a set so no check needed
     for (auto const& pair : systems)
     {
         auto const& system = pair.second;
@@ -29,3 +29,33 @@ void system_manager::entity_signature_changed(entity entity, signature entity_si
         else system->entities.erase(entity);
     }
 }
+
+void system_manager::entities_destroyed(const std::vector<entity>& entities)
+{
+    for (auto const& pair : systems)
+    {
+        auto const& system = pair.second;
+
+        for (entity entity : entities) system->entities.erase(entity);
+    }
+}
+
+void system_manager::entities_signature_changed(const std::vector<entity>& entities, signature entity_signature)
+{
+    // All entities share the signature, so each system is matched only once
+    for (auto const& pair : systems)
+    {
+        auto const& type = pair.first;
+        auto const& system = pair.second;
+        auto const& systemSignature = signatures[type];
+
+        if ((entity_signature & systemSignature) == systemSignature)
+        {
+            for (entity entity : entities) system->entities.insert(entity);
+        }
+        else
+        {
+            for (entity entity : entities) system->entities.erase(entity);
+        }
+    }
+}
@@ -1,4 +1,5 @@
 #include "systems/basic_render_system.hpp"
+#include "components/rigidbody.hpp"
 #include "components/transform.hpp"
 #include <SFML/Graphics/RenderWindow.hpp>
 #include <SFML/Graphics/View.hpp>
@@ -6,13 +7,11 @@
 #include "systems/inventory_system.hpp"
 
 void basic_render_system::update(sf::RenderWindow& window) {
-    for (auto entity : entities) {
-        auto& entity_state_comp = g_conductor.get_component<entity_state>(entity);
+    for (auto [entity, entity_state_comp, sprite1, transform1] :
+         g_conductor.view<entity_state, sprite, transform>()) {
         if (!entity_state_comp.is_active) {
             continue;
         }
-        auto& sprite1 = g_conductor.get_component<sprite>(entity);
-        auto& transform1 = g_conductor.get_component<transform>(entity);
         if (sprite1.sprite_obj.has_value()) {
             sprite1.sprite_obj->setPosition({transform1.position[0], transform1.position[1]});
             sprite1.sprite_obj->setScale({transform1.scale[0], transform1.scale[1]});
@@ -20,4 +19,19 @@ void basic_render_system::update(sf::RenderWindow& window) {
             window.draw(*sprite1.sprite_obj);
         }
     }
+}
+
+void basic_render_system::draw_hitboxes(sf::RenderWindow& window) {
+    for (auto [entity, entity_state_comp, rigidbody1] : g_conductor.view<entity_state, rigidbody>()) {
+        if (!entity_state_comp.is_active || !rigidbody1.can_collide) {
+            continue;
+        }
+        // The shape is only rebuilt here, collision works on the plain bounds
+        rigidbody1.Hitbox.setPosition({rigidbody1.bounds.position[0], rigidbody1.bounds.position[1]});
+        rigidbody1.Hitbox.setSize({rigidbody1.bounds.size[0], rigidbody1.bounds.size[1]});
+        rigidbody1.Hitbox.setFillColor(sf::Color::Transparent);
+        rigidbody1.Hitbox.setOutlineColor(sf::Color::Red);
+        rigidbody1.Hitbox.setOutlineThickness(1.0f);
+        window.draw(rigidbody1.Hitbox);
+    }
 }
\ No newline at end of file
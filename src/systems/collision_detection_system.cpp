@@ -3,379 +3,675 @@
 #include "components/rigidbody.hpp"
 #include "components/transform.hpp"
 #include "help_functions.hpp"
-#include "systems/jump_system.hpp"
+#include "spatial_hash_grid.hpp"
+#include "sweep_and_prune.hpp"
 #include <SFML/Graphics/Rect.hpp>
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <iostream>
+#include <utility>
+
+// Fewest candidate pairs worth handing to another thread
+constexpr std::size_t MIN_PARALLEL_PAIRS = 128;
+// A body is at rest while slower than this (pixels per second)...
+constexpr float SLEEP_SPEED = 5.0f;
+// ...and moving less than this per update (pixels)
+constexpr float SLEEP_DISTANCE = 0.05f;
+// Updates an island has to stay at rest before it sleeps
+constexpr std::uint16_t SLEEP_FRAMES = 30;
+// Union-find slot of a body that isn't awake
+constexpr std::uint32_t NO_SLOT = 0xFFFFFFFF;
+
+collision_detection_system::collision_detection_system()
+    : m_broad_phase(std::make_unique<spatial_hash_grid>()) {
+    // Pairs are reported in insertion order, so keep membership sorted for
+    // deterministic results
+    entities.set_sorted(true);
+}
+
+void collision_detection_system::sync_bounds(rigidbody &rigidbody_comp, const transform &transform_comp) {
+    rigidbody_comp.bounds.position[0] = transform_comp.position[0];
+    rigidbody_comp.bounds.position[1] = transform_comp.position[1];
+    // Calculate actual size by multiplying base_size by scale
+    rigidbody_comp.bounds.size[0] = rigidbody_comp.base_size[0] * transform_comp.scale[0];
+    rigidbody_comp.bounds.size[1] = rigidbody_comp.base_size[1] * transform_comp.scale[1];
+}
+
+void collision_detection_system::set_broad_phase(broad_phase_mode mode) {
+    if (mode == broad_phase_mode::sweep_and_prune) {
+        m_broad_phase = std::make_unique<sweep_and_prune>();
+    } else {
+        m_broad_phase = std::make_unique<spatial_hash_grid>();
+    }
+}
 
-void collision_detection_system::update(jump_system &jump_system) {
-    // First pass: Update hitboxes to align with current transform
-    // NOTE: We update hitboxes for ALL entities (including remote ones) because
-    // other systems (like inventory_system) need accurate hitbox positions
+void collision_detection_system::update(thread_pool *pool) {
+    // First pass: Find the active collidable bodies, static and dynamic
+    m_seen_static_entities.clear();
+    m_dynamic_entities.clear();
     for (auto &entity : entities) {
         auto &entity_state_comp = g_conductor.get_component<entity_state>(entity);
-        auto &transform_comp = g_conductor.get_component<transform>(entity);
         auto &rigidbody_comp = g_conductor.get_component<rigidbody>(entity);
         if (!entity_state_comp.is_active || !rigidbody_comp.can_collide) {
             continue;
         }
+        // Static bodies are already in the static tree
+        if (rigidbody_comp.is_static) {
+            m_seen_static_entities.push_back(entity);
+            continue;
+        }
+        // Count the sleeping members of each island, and note islands with
+        // a member woken from outside
+        if (rigidbody_comp.sleep_island != NO_SLEEP_ISLAND) {
+            if (rigidbody_comp.sleep_island >= m_islands.size()) {
+                // Copied from a body of another simulation (e.g. over the network)
+                wake(rigidbody_comp);
+                rigidbody_comp.sleep_island = NO_SLEEP_ISLAND;
+            } else if (rigidbody_comp.is_sleeping) {
+                ++m_islands[rigidbody_comp.sleep_island].seen;
+            } else {
+                m_islands[rigidbody_comp.sleep_island].disturbed = true;
+            }
+        }
+        m_dynamic_entities.push_back(entity);
+    }
+    wake_disturbed_islands();
 
-        // Sync hitbox with transform: position and scale
-        rigidbody_comp.Hitbox.setPosition({transform_comp.position[0], transform_comp.position[1]});
-        // Calculate actual size by multiplying base_size by scale
-        float actualWidth = rigidbody_comp.base_size[0] * transform_comp.scale[0];
-        float actualHeight = rigidbody_comp.base_size[1] * transform_comp.scale[1];
-        rigidbody_comp.Hitbox.setSize({actualWidth, actualHeight});
+    // Static bodies are visited in the same (sorted) order every update, so
+    // any change to the set shows up as a different list
+    if (m_seen_static_entities != m_static_entities) {
+        rebuild_static_tree();
     }
 
-    // Second pass: Collision detection and resolution
-    // Only check entities that have moved, or pairs where at least one has moved
-    for (auto it1 = entities.begin(); it1 != entities.end(); ++it1) {
-        auto &entity1 = *it1;
-        auto &transform1 = g_conductor.get_component<transform>(entity1);
-        auto &rigidbody1 = g_conductor.get_component<rigidbody>(entity1);
-        auto &entity_state_comp1 = g_conductor.get_component<entity_state>(entity1);
-        if (!entity_state_comp1.is_active || !rigidbody1.can_collide) {
+    // Update collision bounds to align with current transform, and insert
+    // every dynamic body into the broad-phase. Fast bodies are first swept
+    // from their last position so they can't pass through static geometry
+    // NOTE: We update bounds for ALL entities (including remote ones) because
+    // other systems (like inventory_system) need accurate positions
+    m_broad_phase->begin_frame();
+    m_static_queries.clear();
+    m_moved.clear();
+    m_last_touching.swap(m_touching);
+    m_touching.clear();
+    for (auto &entity : m_dynamic_entities) {
+        auto &transform_comp = g_conductor.get_component<transform>(entity);
+        auto &rigidbody_comp = g_conductor.get_component<rigidbody>(entity);
+        // Sleeping bodies haven't moved, so their bounds are current. They
+        // are only obstacles - pairs where neither body moved are never tested
+        if (rigidbody_comp.is_sleeping) {
+            const aabb &bounds = rigidbody_comp.bounds;
+            m_broad_phase->insert(entity, bounds.position[0], bounds.position[1], bounds.size[0], bounds.size[1],
+                                  false, rigidbody_comp.layer, rigidbody_comp.mask);
             continue;
         }
+        if (!m_static_tree.empty()) {
+            sweep_against_static(entity, transform_comp, rigidbody_comp);
+        }
 
-        // Check if entity1 has moved
-        float lastX1 = transform1.last_position[0];
-        float lastY1 = transform1.last_position[1];
-        float x1 = transform1.position[0];
-        float y1 = transform1.position[1];
-        bool entity1Moved = (x1 != lastX1 || y1 != lastY1);
-
-        // Calculate actual size by multiplying base_size by scale
-        float w1 = rigidbody1.base_size[0] * transform1.scale[0];
-        float h1 = rigidbody1.base_size[1] * transform1.scale[1];
-
-        for (auto it2 = std::next(it1); it2 != entities.end(); ++it2) {
-            auto &entity2 = *it2;
-            auto &transform2 = g_conductor.get_component<transform>(entity2);
-            auto &rigidbody2 = g_conductor.get_component<rigidbody>(entity2);
-            auto &entity_state_comp2 = g_conductor.get_component<entity_state>(entity2);
-            if (!entity_state_comp2.is_active || !rigidbody2.can_collide) {
-                continue;
-            }
-
-            // Check if entity2 has moved
-            float lastX2 = transform2.last_position[0];
-            float lastY2 = transform2.last_position[1];
-            float x2 = transform2.position[0];
-            float y2 = transform2.position[1];
-            bool entity2Moved = (x2 != lastX2 || y2 != lastY2);
-
-            // Skip collision check if neither entity has moved (both are stationary)
-            if (!entity1Moved && !entity2Moved) {
-                continue;
-            }
+        // Sync bounds with transform: position and scale
+        sync_bounds(rigidbody_comp, transform_comp);
+        float actualWidth = rigidbody_comp.bounds.size[0];
+        float actualHeight = rigidbody_comp.bounds.size[1];
+
+        bool moved = transform_comp.position[0] != transform_comp.last_position[0] ||
+                     transform_comp.position[1] != transform_comp.last_position[1];
+        m_broad_phase->insert(entity, transform_comp.position[0], transform_comp.position[1], actualWidth, actualHeight,
+                      moved, rigidbody_comp.layer, rigidbody_comp.mask);
+        // Only bodies that moved can have started touching static geometry
+        if (moved) {
+            m_static_queries.push_back(entity);
+            m_moved.insert(entity);
+        }
+    }
 
-            // Calculate actual size by multiplying base_size by scale
-            float w2 = rigidbody2.base_size[0] * transform2.scale[0];
-            float h2 = rigidbody2.base_size[1] * transform2.scale[1];
-
-            // Check if the two hitboxes intersect at current position
-            if (rectanglesIntersect(x1, y1, w1, h1, x2, y2, w2, h2)) {
-                // Check if they were colliding at last position
-                bool wasColliding = rectanglesIntersect(lastX1, lastY1, w1, h1, lastX2, lastY2, w2, h2);
-
-                if (!wasColliding) {
-                    // They weren't colliding before, so move them back towards last positions
-                    // Calculate movement vectors from last to current position
-                    float moveX1 = x1 - lastX1;
-                    float moveY1 = y1 - lastY1;
-                    float moveX2 = x2 - lastX2;
-                    float moveY2 = y2 - lastY2;
-
-                    // Calculate total movement magnitude for each entity
-                    float moveMag1 = std::sqrt(moveX1 * moveX1 + moveY1 * moveY1);
-                    float moveMag2 = std::sqrt(moveX2 * moveX2 + moveY2 * moveY2);
-
-                    // Calculate rectangle boundaries at current position
-                    float rect1Left = x1;
-                    float rect1Right = x1 + w1;
-                    float rect1Top = y1;
-                    float rect1Bottom = y1 + h1;
-
-                    float rect2Left = x2;
-                    float rect2Right = x2 + w2;
-                    float rect2Top = y2;
-                    float rect2Bottom = y2 + h2;
-
-                    // Calculate overlap
-                    float overlapLeft = rect1Right - rect2Left;
-                    float overlapRight = rect2Right - rect1Left;
-                    float overlapTop = rect1Bottom - rect2Top;
-                    float overlapBottom = rect2Bottom - rect1Top;
-
-                    // Find the minimum overlap (the axis of least penetration)
-                    float minOverlapX = std::min(overlapLeft, overlapRight);
-                    float minOverlapY = std::min(overlapTop, overlapBottom);
-
-                    float totalMass = rigidbody1.Mass + rigidbody2.Mass;
-                    if (totalMass > 0.0f) {
-                        float massRatio1 = rigidbody2.Mass / totalMass;
-                        float massRatio2 = rigidbody1.Mass / totalMass;
-
-                        // Prioritize vertical (Y-axis) collisions to prevent side clipping when falling
-                        if (minOverlapY > 0.0f && (minOverlapY <= minOverlapX || minOverlapX <= 0.0f)) {
-                            // Resolve collision on Y axis first
-                            // Only move entities that have moved
-                            float separation1 = 0.0f;
-                            float separation2 = 0.0f;
-
-                            if (entity1Moved && entity2Moved) {
-                                // Both moved, separate based on their movement direction
-                                float moveRatio1 = moveMag1 / (moveMag1 + moveMag2);
-                                float moveRatio2 = moveMag2 / (moveMag1 + moveMag2);
-
-                                if (overlapTop < overlapBottom) {
-                                    // entity1 is on top, push it up
-                                    separation1 = -minOverlapY * massRatio1 * moveRatio1;
-                                    separation2 = minOverlapY * massRatio2 * moveRatio2;
-                                } else {
-                                    // entity1 is on bottom, push it down
-                                    separation1 = minOverlapY * massRatio1 * moveRatio1;
-                                    separation2 = -minOverlapY * massRatio2 * moveRatio2;
-                                }
-                            } else if (entity1Moved) {
-                                // Only entity1 moved, push it back completely
-                                if (overlapTop < overlapBottom) {
-                                    separation1 = -minOverlapY;
-                                    // entity2 stays stationary, no separation
-                                } else {
-                                    separation1 = minOverlapY;
-                                    // entity2 stays stationary, no separation
-                                }
-                            } else if (entity2Moved) {
-                                // Only entity2 moved, push it back completely
-                                if (overlapTop < overlapBottom) {
-                                    // entity1 stays stationary, no separation
-                                    separation2 = minOverlapY;
-                                } else {
-                                    // entity1 stays stationary, no separation
-                                    separation2 = -minOverlapY;
-                                }
-                            }
-
-                            // Only apply separation to entities that have moved
-                            if (entity1Moved && separation1 != 0.0f) {
-                                transform1.position[1] += separation1;
-                                // Update hitbox positions
-                                rigidbody1.Hitbox.setPosition({transform1.position[0], transform1.position[1]});
-                                rigidbody1.Hitbox.setSize({rigidbody1.base_size[0] * transform1.scale[0], rigidbody1.base_size[1] * transform1.scale[1]});
-                                // Stop velocity only if collision is in the direction of movement
-                                // If moving up (negative velocity) and being pushed down (positive separation), reset
-                                // If moving down (positive velocity) and being pushed up (negative separation), reset
-                                if ((rigidbody1.velocity[1] < 0.0f && separation1 > 0.0f) ||
-                                    (rigidbody1.velocity[1] > 0.0f && separation1 < 0.0f)) {
-                                    // If landing (moving down and being pushed up), reset jump
-                                    if (rigidbody1.velocity[1] > 0.0f && separation1 < 0.0f) {
-                                        jump_system.reset_jump(entity1);
-                                    }
-                                    rigidbody1.velocity[1] = 0.0f;
-                                }
-                            }
-
-                            if (entity2Moved && separation2 != 0.0f) {
-                                transform2.position[1] += separation2;
-                                // Update hitbox positions
-                                rigidbody2.Hitbox.setPosition({transform2.position[0], transform2.position[1]});
-                                rigidbody2.Hitbox.setSize({rigidbody2.base_size[0] * transform2.scale[0], rigidbody2.base_size[1] * transform2.scale[1]});
-                                // Stop velocity only if collision is in the direction of movement
-                                // If moving up (negative velocity) and being pushed down (positive separation), reset
-                                // If moving down (positive velocity) and being pushed up (negative separation), reset
-                                if ((rigidbody2.velocity[1] < 0.0f && separation2 > 0.0f) ||
-                                    (rigidbody2.velocity[1] > 0.0f && separation2 < 0.0f)) {
-                                    // If landing (moving down and being pushed up), reset jump
-                                    if (rigidbody2.velocity[1] > 0.0f && separation2 < 0.0f) {
-                                        jump_system.reset_jump(entity2);
-                                    }
-                                    rigidbody2.velocity[1] = 0.0f;
-                                }
-                            }
-                        } else if (minOverlapX > 0.0f) {
-                            // Resolve collision on X axis (only if Y-axis wasn't resolved)
-                            // Only move entities that have moved
-                            float separation1 = 0.0f;
-                            float separation2 = 0.0f;
-
-                            if (entity1Moved && entity2Moved) {
-                                // Both moved, separate based on their movement direction
-                                float moveRatio1 = moveMag1 / (moveMag1 + moveMag2);
-                                float moveRatio2 = moveMag2 / (moveMag1 + moveMag2);
-
-                                if (overlapLeft < overlapRight) {
-                                    // entity1 is on the left, push it left
-                                    separation1 = -minOverlapX * massRatio1 * moveRatio1;
-                                    separation2 = minOverlapX * massRatio2 * moveRatio2;
-                                } else {
-                                    // entity1 is on the right, push it right
-                                    separation1 = minOverlapX * massRatio1 * moveRatio1;
-                                    separation2 = -minOverlapX * massRatio2 * moveRatio2;
-                                }
-                            } else if (entity1Moved) {
-                                // Only entity1 moved, push it back completely
-                                if (overlapLeft < overlapRight) {
-                                    separation1 = -minOverlapX;
-                                    // entity2 stays stationary, no separation
-                                } else {
-                                    separation1 = minOverlapX;
-                                    // entity2 stays stationary, no separation
-                                }
-                            } else if (entity2Moved) {
-                                // Only entity2 moved, push it back completely
-                                if (overlapLeft < overlapRight) {
-                                    // entity1 stays stationary, no separation
-                                    separation2 = minOverlapX;
-                                } else {
-                                    // entity1 stays stationary, no separation
-                                    separation2 = -minOverlapX;
-                                }
-                            }
-
-                            // Only apply separation to entities that have moved
-                            if (entity1Moved && separation1 != 0.0f) {
-                                transform1.position[0] += separation1;
-                                // Update hitbox positions
-                                rigidbody1.Hitbox.setPosition({transform1.position[0], transform1.position[1]});
-                                rigidbody1.Hitbox.setSize({rigidbody1.base_size[0] * transform1.scale[0], rigidbody1.base_size[1] * transform1.scale[1]});
-                                // Stop velocity in the collision direction
-                                rigidbody1.velocity[0] = 0.0f;
-                            }
-
-                            if (entity2Moved && separation2 != 0.0f) {
-                                transform2.position[0] += separation2;
-                                // Update hitbox positions
-                                rigidbody2.Hitbox.setPosition({transform2.position[0], transform2.position[1]});
-                                rigidbody2.Hitbox.setSize({rigidbody2.base_size[0] * transform2.scale[0], rigidbody2.base_size[1] * transform2.scale[1]});
-                                // Stop velocity in the collision direction
-                                rigidbody2.velocity[0] = 0.0f;
-                            }
-                        }
-                    }
+    // Second pass: Broad-phase - only pairs whose boxes overlap, where at
+    // least one entity has moved, reach the narrow-phase. Moving bodies find
+    // the static bodies they touch through the static tree
+    m_broad_phase->collect_pairs(m_pairs);
+    if (!m_static_tree.empty() && !m_static_queries.empty()) {
+        for (auto &entity : m_static_queries) {
+            const auto &transform_comp = g_conductor.get_component<transform>(entity);
+            const auto &rigidbody_comp = g_conductor.get_component<rigidbody>(entity);
+            m_static_hits.clear();
+            m_static_tree.query(transform_comp.position[0], transform_comp.position[1],
+                                rigidbody_comp.base_size[0] * transform_comp.scale[0],
+                                rigidbody_comp.base_size[1] * transform_comp.scale[1], rigidbody_comp.layer,
+                                rigidbody_comp.mask, m_static_hits);
+            for (auto &static_entity : m_static_hits) {
+                if (entity_index(static_entity) < entity_index(entity)) {
+                    m_pairs.emplace_back(static_entity, entity);
                 } else {
-                    // They were already colliding at last position
-                    // Only resolve if at least one entity has moved
-                    if (entity1Moved || entity2Moved) {
-                        // Calculate rectangle boundaries
-                        float rect1Left = x1;
-                        float rect1Right = x1 + w1;
-                        float rect1Top = y1;
-                        float rect1Bottom = y1 + h1;
-
-                        float rect2Left = x2;
-                        float rect2Right = x2 + w2;
-                        float rect2Top = y2;
-                        float rect2Bottom = y2 + h2;
-
-                        // Calculate overlap
-                        float overlapLeft = rect1Right - rect2Left;
-                        float overlapRight = rect2Right - rect1Left;
-                        float overlapTop = rect1Bottom - rect2Top;
-                        float overlapBottom = rect2Bottom - rect1Top;
-
-                        // Find the minimum overlap (the axis of least penetration)
-                        float minOverlapX = std::min(overlapLeft, overlapRight);
-                        float minOverlapY = std::min(overlapTop, overlapBottom);
-
-                        float totalMass = rigidbody1.Mass + rigidbody2.Mass;
-                        if (totalMass > 0.0f) {
-                            float massRatio1 = rigidbody2.Mass / totalMass;
-                            float massRatio2 = rigidbody1.Mass / totalMass;
-
-                            // Prioritize vertical (Y-axis) collisions to prevent side clipping when falling
-                            if (minOverlapY > 0.0f && (minOverlapY <= minOverlapX || minOverlapX <= 0.0f)) {
-                                // Resolve collision on Y axis first
-                                float separation1 = 0.0f;
-                                float separation2 = 0.0f;
-
-                                if (overlapTop < overlapBottom) {
-                                    // entity1 is on top, push it up
-                                    separation1 = -minOverlapY * massRatio1;
-                                    separation2 = minOverlapY * massRatio2;
-                                } else {
-                                    // entity1 is on bottom, push it down
-                                    separation1 = minOverlapY * massRatio1;
-                                    separation2 = -minOverlapY * massRatio2;
-                                }
-
-                                // Only apply separation to entities that have moved
-                                if (entity1Moved && separation1 != 0.0f) {
-                                    transform1.position[1] += separation1;
-                                    // Update hitbox positions and scales to match transforms
-                                    rigidbody1.Hitbox.setPosition({transform1.position[0], transform1.position[1]});
-                                    rigidbody1.Hitbox.setSize({rigidbody1.base_size[0] * transform1.scale[0], rigidbody1.base_size[1] * transform1.scale[1]});
-                                    // Stop velocity only if collision is in the direction of movement
-                                    // If moving up (negative velocity) and being pushed down (positive separation), reset
-                                    // If moving down (positive velocity) and being pushed up (negative separation), reset
-                                    if ((rigidbody1.velocity[1] < 0.0f && separation1 > 0.0f) ||
-                                        (rigidbody1.velocity[1] > 0.0f && separation1 < 0.0f)) {
-                                        // If landing (moving down and being pushed up), reset jump
-                                        if (rigidbody1.velocity[1] > 0.0f && separation1 < 0.0f) {
-                                            jump_system.reset_jump(entity1);
-                                        }
-                                        rigidbody1.velocity[1] = 0.0f;
-                                    }
-                                }
-
-                                if (entity2Moved && separation2 != 0.0f) {
-                                    transform2.position[1] += separation2;
-                                    // Update hitbox positions and scales to match transforms
-                                    rigidbody2.Hitbox.setPosition({transform2.position[0], transform2.position[1]});
-                                    rigidbody2.Hitbox.setSize({rigidbody2.base_size[0] * transform2.scale[0], rigidbody2.base_size[1] * transform2.scale[1]});
-                                    // Stop velocity only if collision is in the direction of movement
-                                    // If moving up (negative velocity) and being pushed down (positive separation), reset
-                                    // If moving down (positive velocity) and being pushed up (negative separation), reset
-                                    if ((rigidbody2.velocity[1] < 0.0f && separation2 > 0.0f) ||
-                                        (rigidbody2.velocity[1] > 0.0f && separation2 < 0.0f)) {
-                                        // If landing (moving down and being pushed up), reset jump
-                                        if (rigidbody2.velocity[1] > 0.0f && separation2 < 0.0f) {
-                                            jump_system.reset_jump(entity2);
-                                        }
-                                        rigidbody2.velocity[1] = 0.0f;
-                                    }
-                                }
-                            } else if (minOverlapX > 0.0f) {
-                                // Resolve collision on X axis (only if Y-axis wasn't resolved)
-                                float separation1 = 0.0f;
-                                float separation2 = 0.0f;
-
-                                if (overlapLeft < overlapRight) {
-                                    // entity1 is on the left, push it left
-                                    separation1 = -minOverlapX * massRatio1;
-                                    separation2 = minOverlapX * massRatio2;
-                                } else {
-                                    // entity1 is on the right, push it right
-                                    separation1 = minOverlapX * massRatio1;
-                                    separation2 = -minOverlapX * massRatio2;
-                                }
-
-                                // Only apply separation to entities that have moved
-                                if (entity1Moved && separation1 != 0.0f) {
-                                    transform1.position[0] += separation1;
-                                    // Update hitbox positions and scales to match transforms
-                                    rigidbody1.Hitbox.setPosition({transform1.position[0], transform1.position[1]});
-                                    rigidbody1.Hitbox.setSize({rigidbody1.base_size[0] * transform1.scale[0], rigidbody1.base_size[1] * transform1.scale[1]});
-                                    // Stop velocity in the collision direction
-                                    rigidbody1.velocity[0] = 0.0f;
-                                }
-
-                                if (entity2Moved && separation2 != 0.0f) {
-                                    transform2.position[0] += separation2;
-                                    // Update hitbox positions and scales to match transforms
-                                    rigidbody2.Hitbox.setPosition({transform2.position[0], transform2.position[1]});
-                                    rigidbody2.Hitbox.setSize({rigidbody2.base_size[0] * transform2.scale[0], rigidbody2.base_size[1] * transform2.scale[1]});
-                                    // Stop velocity in the collision direction
-                                    rigidbody2.velocity[0] = 0.0f;
-                                }
-                            }
-                        }
-                    }
+                    m_pairs.emplace_back(entity, static_entity);
                 }
             }
         }
+        // Resolve in entity order, as if every body had gone through the broad-phase
+        std::sort(m_pairs.begin(), m_pairs.end(), [](const entity_pair &a, const entity_pair &b) {
+            return std::make_pair(entity_index(a.first), entity_index(a.second)) <
+                   std::make_pair(entity_index(b.first), entity_index(b.second));
+        });
+    }
+
+    // Third pass: Narrow-phase collision detection and resolution
+    resolve_pairs(pool);
+    publish_events();
+
+    // Finally, put bodies that have come to rest to sleep
+    update_sleep();
+}
+
+void collision_detection_system::resolve_pairs(thread_pool *pool) {
+    // Last positions don't change while pairs are resolved, so the overlap
+    // there is tested for all pairs up front
+    test_last_positions();
+    m_pair_landed.assign(m_pairs.size(), 0);
+    if (pool == nullptr || m_pairs.size() < 2 * MIN_PARALLEL_PAIRS) {
+        contact resolved;
+        for (std::size_t i = 0; i < m_pairs.size(); ++i) {
+            if (compute_contact(m_pairs[i].first, m_pairs[i].second, m_was_colliding[i] != 0, resolved)) {
+                m_pair_landed[i] = apply_contact(resolved);
+            }
+        }
+        return;
+    }
+
+    // Parallel mode: the contacts of all pairs are computed concurrently from
+    // the positions left by the broad-phase, each into the pair's own slot
+    m_contacts.resize(m_pairs.size());
+    pool->parallel_for(m_pairs.size(), MIN_PARALLEL_PAIRS, [this](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            m_contacts[i].valid = compute_contact(m_pairs[i].first, m_pairs[i].second, m_was_colliding[i] != 0,
+                                                  m_contacts[i].resolved);
+        }
+    });
+
+    // Then they are applied in pair order. A contact whose entities were
+    // pushed by an earlier one is stale and computed again, so the result is
+    // the same as resolving sequentially, whatever the thread count
+    m_displaced.clear();
+    for (std::size_t i = 0; i < m_pairs.size(); ++i) {
+        const auto &[entity1, entity2] = m_pairs[i];
+        pending_contact &pending = m_contacts[i];
+        if (m_displaced.contains(entity1) || m_displaced.contains(entity2)) {
+            pending.valid = compute_contact(entity1, entity2, m_was_colliding[i] != 0, pending.resolved);
+        }
+        if (!pending.valid) {
+            continue;
+        }
+        m_pair_landed[i] = apply_contact(pending.resolved);
+        if (pending.resolved.separation1 != 0.0f) {
+            m_displaced.insert(entity1);
+        }
+        if (pending.resolved.separation2 != 0.0f) {
+            m_displaced.insert(entity2);
+        }
+    }
+}
+
+void collision_detection_system::publish_events() {
+    // Every candidate pair overlapped when the broad-phase found it. Like
+    // swept hits, its entities are already ordered by index
+    for (std::size_t i = 0; i < m_pairs.size(); ++i) {
+        const auto &[entity1, entity2] = m_pairs[i];
+        bool trigger = g_conductor.get_component<rigidbody>(entity1).is_trigger ||
+                       g_conductor.get_component<rigidbody>(entity2).is_trigger;
+        m_touching.push_back(touching_pair{m_pairs[i], m_pair_landed[i], trigger});
+    }
+    // Pairs where neither body moved are never candidates, so contacts of
+    // the last update between bodies that stayed put carry over
+    for (auto &last : m_last_touching) {
+        const auto &[entity1, entity2] = last.pair;
+        if (!m_moved.contains(entity1) && !m_moved.contains(entity2) && is_colliding_body(entity1) &&
+            is_colliding_body(entity2)) {
+            m_touching.push_back(last);
+        }
+    }
+
+    // A pair found more than once (e.g. swept and then a candidate) keeps every landing
+    std::sort(m_touching.begin(), m_touching.end(),
+              [](const touching_pair &a, const touching_pair &b) { return a.pair < b.pair; });
+    std::size_t count = 0;
+    for (auto &found : m_touching) {
+        if (count > 0 && m_touching[count - 1].pair == found.pair) {
+            m_touching[count - 1].landed |= found.landed;
+            m_touching[count - 1].trigger = m_touching[count - 1].trigger || found.trigger;
+        } else {
+            m_touching[count++] = found;
+        }
+    }
+    m_touching.resize(count);
+
+    // Merge with the last update's contacts, both sorted by pair
+    m_events.clear();
+    std::size_t last = 0;
+    std::size_t current = 0;
+    while (last < m_last_touching.size() || current < m_touching.size()) {
+        if (current == m_touching.size() ||
+            (last < m_last_touching.size() && m_last_touching[last].pair < m_touching[current].pair)) {
+            const auto &ended = m_last_touching[last++];
+            m_events.push_back(collision_event{ended.pair.first, ended.pair.second, collision_phase::exit, false, false,
+                                               ended.trigger});
+            continue;
+        }
+        const auto &found = m_touching[current++];
+        collision_phase phase = collision_phase::enter;
+        if (last < m_last_touching.size() && m_last_touching[last].pair == found.pair) {
+            phase = collision_phase::stay;
+            ++last;
+        }
+        m_events.push_back(collision_event{found.pair.first, found.pair.second, phase,
+                                           (found.landed & LANDED_FIRST) != 0,
+                                           (found.landed & LANDED_SECOND) != 0, found.trigger});
+    }
+}
+
+bool collision_detection_system::is_colliding_body(entity ent) const {
+    if (!entities.contains(ent)) {
+        return false;
+    }
+    return g_conductor.get_component<entity_state>(ent).is_active &&
+           g_conductor.get_component<rigidbody>(ent).can_collide;
+}
+
+void collision_detection_system::update_sleep() {
+    // Track how long each awake body has been at rest, and give it a slot
+    // in the union-find used to group bodies into islands
+    m_awake_bodies.clear();
+    for (auto &entity : m_dynamic_entities) {
+        auto &transform_comp = g_conductor.get_component<transform>(entity);
+        auto &rigidbody_comp = g_conductor.get_component<rigidbody>(entity);
+        std::size_t index = entity_index(entity);
+        if (index >= m_body_slots.size()) {
+            m_body_slots.resize(index + 1, NO_SLOT);
+        }
+        if (rigidbody_comp.is_sleeping) {
+            m_body_slots[index] = NO_SLOT;
+            continue;
+        }
+
+        float moveX = transform_comp.position[0] - transform_comp.last_position[0];
+        float moveY = transform_comp.position[1] - transform_comp.last_position[1];
+        float speedSquared = rigidbody_comp.velocity[0] * rigidbody_comp.velocity[0] +
+                             rigidbody_comp.velocity[1] * rigidbody_comp.velocity[1];
+        bool still = speedSquared <= SLEEP_SPEED * SLEEP_SPEED &&
+                     moveX * moveX + moveY * moveY <= SLEEP_DISTANCE * SLEEP_DISTANCE;
+        if (!still) {
+            rigidbody_comp.still_frames = 0;
+        } else if (rigidbody_comp.still_frames < SLEEP_FRAMES) {
+            ++rigidbody_comp.still_frames;
+        }
+
+        m_body_slots[index] = static_cast<std::uint32_t>(m_awake_bodies.size());
+        m_awake_bodies.push_back(entity);
+    }
+
+    // Bodies in contact form an island. A moving body that ran into a
+    // sleeping one wakes the sleeper's island instead
+    m_island_parents.resize(m_awake_bodies.size());
+    for (std::uint32_t i = 0; i < m_island_parents.size(); ++i) {
+        m_island_parents[i] = i;
+    }
+    for (const auto &[entity1, entity2] : m_pairs) {
+        auto &rigidbody1 = g_conductor.get_component<rigidbody>(entity1);
+        auto &rigidbody2 = g_conductor.get_component<rigidbody>(entity2);
+        // Triggers don't hold anything up, so they neither join nor wake islands
+        if (rigidbody1.is_static || rigidbody2.is_static || rigidbody1.is_trigger || rigidbody2.is_trigger) {
+            continue;
+        }
+        if (rigidbody1.is_sleeping) {
+            wake_island(rigidbody1.sleep_island);
+        }
+        if (rigidbody2.is_sleeping) {
+            wake_island(rigidbody2.sleep_island);
+        }
+        std::uint32_t slot1 = m_body_slots[entity_index(entity1)];
+        std::uint32_t slot2 = m_body_slots[entity_index(entity2)];
+        if (slot1 != NO_SLOT && slot2 != NO_SLOT) {
+            m_island_parents[find_island_root(slot1)] = find_island_root(slot2);
+        }
+    }
+
+    // An island sleeps once every body in it has been at rest long enough
+    m_island_still.assign(m_awake_bodies.size(), SLEEP_FRAMES);
+    for (std::uint32_t i = 0; i < m_awake_bodies.size(); ++i) {
+        const auto &rigidbody_comp = g_conductor.get_component<rigidbody>(m_awake_bodies[i]);
+        std::uint32_t root = find_island_root(i);
+        m_island_still[root] = std::min(m_island_still[root], rigidbody_comp.still_frames);
+    }
+    m_root_islands.assign(m_awake_bodies.size(), NO_SLEEP_ISLAND);
+    for (std::uint32_t i = 0; i < m_awake_bodies.size(); ++i) {
+        std::uint32_t root = find_island_root(i);
+        if (m_island_still[root] < SLEEP_FRAMES) {
+            continue;
+        }
+        if (m_root_islands[root] == NO_SLEEP_ISLAND) {
+            m_root_islands[root] = allocate_island();
+        }
+
+        entity ent = m_awake_bodies[i];
+        auto &transform_comp = g_conductor.get_component<transform>(ent);
+        auto &rigidbody_comp = g_conductor.get_component<rigidbody>(ent);
+        rigidbody_comp.is_sleeping = true;
+        rigidbody_comp.sleep_island = m_root_islands[root];
+        rigidbody_comp.velocity[0] = 0.0f;
+        rigidbody_comp.velocity[1] = 0.0f;
+        transform_comp.last_position[0] = transform_comp.position[0];
+        transform_comp.last_position[1] = transform_comp.position[1];
+        m_islands[m_root_islands[root]].members.push_back(ent);
+    }
+}
+
+std::uint32_t collision_detection_system::find_island_root(std::uint32_t slot) {
+    while (m_island_parents[slot] != slot) {
+        // Path halving
+        m_island_parents[slot] = m_island_parents[m_island_parents[slot]];
+        slot = m_island_parents[slot];
+    }
+    return slot;
+}
+
+std::uint32_t collision_detection_system::allocate_island() {
+    if (!m_free_islands.empty()) {
+        std::uint32_t index = m_free_islands.back();
+        m_free_islands.pop_back();
+        return index;
+    }
+    m_islands.emplace_back();
+    return static_cast<std::uint32_t>(m_islands.size() - 1);
+}
+
+void collision_detection_system::wake_island(std::uint32_t index) {
+    sleep_island &island = m_islands[index];
+    for (entity member : island.members) {
+        // Members may have been destroyed, or copied over since
+        if (!g_conductor.is_alive(member) || !g_conductor.has_component<rigidbody>(member)) {
+            continue;
+        }
+        auto &rigidbody_comp = g_conductor.get_component<rigidbody>(member);
+        if (rigidbody_comp.sleep_island == index) {
+            wake(rigidbody_comp);
+            rigidbody_comp.sleep_island = NO_SLEEP_ISLAND;
+        }
+    }
+    island = sleep_island{};
+    m_free_islands.push_back(index);
+}
+
+void collision_detection_system::wake_disturbed_islands() {
+    for (std::uint32_t i = 0; i < m_islands.size(); ++i) {
+        sleep_island &island = m_islands[i];
+        if (island.members.empty()) {
+            continue; // Free
+        }
+        // Wake when a member was woken from outside or is gone (destroyed,
+        // deactivated or no longer collidable)
+        if (island.disturbed || island.seen != island.members.size()) {
+            wake_island(i);
+        } else {
+            island.seen = 0;
+        }
+    }
+}
+
+void collision_detection_system::test_last_positions() {
+    m_was_colliding.assign(m_pairs.size(), 0);
+    std::size_t run_begin = 0;
+    while (run_begin < m_pairs.size()) {
+        // Pairs are ordered by their first entity, so its pairs are adjacent
+        entity first = m_pairs[run_begin].first;
+        std::size_t run_end = run_begin;
+        m_partner_boxes.clear();
+        while (run_end < m_pairs.size() && m_pairs[run_end].first == first) {
+            const auto &transform_comp = g_conductor.get_component<transform>(m_pairs[run_end].second);
+            const auto &rigidbody_comp = g_conductor.get_component<rigidbody>(m_pairs[run_end].second);
+            m_partner_boxes.push_back(transform_comp.last_position[0], transform_comp.last_position[1],
+                                      rigidbody_comp.base_size[0] * transform_comp.scale[0],
+                                      rigidbody_comp.base_size[1] * transform_comp.scale[1]);
+            ++run_end;
+        }
+
+        const auto &transform_comp = g_conductor.get_component<transform>(first);
+        const auto &rigidbody_comp = g_conductor.get_component<rigidbody>(first);
+        m_hits.clear();
+        rectanglesIntersectBatch(transform_comp.last_position[0], transform_comp.last_position[1],
+                                 rigidbody_comp.base_size[0] * transform_comp.scale[0],
+                                 rigidbody_comp.base_size[1] * transform_comp.scale[1], m_partner_boxes, m_hits);
+        for (std::uint32_t hit : m_hits) {
+            m_was_colliding[run_begin + hit] = 1;
+        }
+        run_begin = run_end;
+    }
+}
+
+void collision_detection_system::sweep_against_static(entity ent, transform &transform_comp,
+                                                      rigidbody &rigidbody_comp) {
+    float lastX = transform_comp.last_position[0];
+    float lastY = transform_comp.last_position[1];
+    float moveX = transform_comp.position[0] - lastX;
+    float moveY = transform_comp.position[1] - lastY;
+    float width = rigidbody_comp.base_size[0] * transform_comp.scale[0];
+    float height = rigidbody_comp.base_size[1] * transform_comp.scale[1];
+    // A body moving less than half its size per step ends up overlapping
+    // anything it hits by less than half, which the discrete pass resolves.
+    // Triggers pass through everything
+    if ((std::abs(moveX) <= width / 2 && std::abs(moveY) <= height / 2) || rigidbody_comp.is_trigger) {
+        return;
+    }
+
+    // Static bodies within the box covering the whole move
+    m_static_hits.clear();
+    m_static_tree.query(std::min(lastX, lastX + moveX), std::min(lastY, lastY + moveY), width + std::abs(moveX),
+                        height + std::abs(moveY), rigidbody_comp.layer, rigidbody_comp.mask, m_static_hits);
+
+    // Earliest time of impact along the move
+    float firstTime = 1.0f;
+    int firstAxis = -1;
+    entity firstEntity = NULL_ENTITY;
+    for (auto &static_entity : m_static_hits) {
+        const auto &static_rigidbody = g_conductor.get_component<rigidbody>(static_entity);
+        if (static_rigidbody.is_trigger) {
+            continue;
+        }
+        const aabb &bounds = static_rigidbody.bounds;
+        float time = 0.0f;
+        int axis = 0;
+        if (sweptRectanglesHit(lastX, lastY, width, height, moveX, moveY, bounds.position[0], bounds.position[1],
+                               bounds.size[0], bounds.size[1], time, axis) &&
+            time < firstTime) {
+            firstTime = time;
+            firstAxis = axis;
+            firstEntity = static_entity;
+        }
+    }
+    if (firstAxis < 0) {
+        return;
+    }
+
+    // Stop at the point of impact on the hit axis and keep sliding along the other
+    float move[2] = {moveX, moveY};
+    transform_comp.position[firstAxis] = transform_comp.last_position[firstAxis] + move[firstAxis] * firstTime;
+    // The bodies now only touch, so report the hit as a contact of its own
+    bool landed = false;
+    if (firstAxis == 0) {
+        // Stop velocity in the collision direction
+        rigidbody_comp.velocity[0] = 0.0f;
+    } else if ((rigidbody_comp.velocity[1] > 0.0f && moveY > 0.0f) ||
+               (rigidbody_comp.velocity[1] < 0.0f && moveY < 0.0f)) {
+        // Stop velocity only if collision is in the direction of movement,
+        // landing if moving down onto the surface
+        landed = moveY > 0.0f;
+        rigidbody_comp.velocity[1] = 0.0f;
+    }
+    if (entity_index(ent) < entity_index(firstEntity)) {
+        m_touching.push_back(touching_pair{entity_pair(ent, firstEntity), landed ? LANDED_FIRST : std::uint8_t(0), false});
+    } else {
+        m_touching.push_back(touching_pair{entity_pair(firstEntity, ent), landed ? LANDED_SECOND : std::uint8_t(0), false});
+    }
+}
+
+void collision_detection_system::rebuild_static_tree() {
+    std::vector<static_bvh::box> boxes;
+    boxes.reserve(m_seen_static_entities.size());
+    for (auto &entity : m_seen_static_entities) {
+        auto &transform_comp = g_conductor.get_component<transform>(entity);
+        auto &rigidbody_comp = g_conductor.get_component<rigidbody>(entity);
+        // Static bounds only need syncing when the tree is rebuilt
+        sync_bounds(rigidbody_comp, transform_comp);
+        const aabb &bounds = rigidbody_comp.bounds;
+        boxes.push_back(static_bvh::box{entity, bounds.position[0], bounds.position[1],
+                                        bounds.position[0] + bounds.size[0], bounds.position[1] + bounds.size[1],
+                                        rigidbody_comp.layer, rigidbody_comp.mask});
+    }
+    m_static_tree.build(std::move(boxes));
+    m_static_entities = m_seen_static_entities;
+}
+
+bool collision_detection_system::compute_contact(entity entity1, entity entity2, bool was_colliding,
+                                                 contact &result) const {
+    const auto &transform1 = g_conductor.get_component<transform>(entity1);
+    const auto &rigidbody1 = g_conductor.get_component<rigidbody>(entity1);
+    const auto &transform2 = g_conductor.get_component<transform>(entity2);
+    const auto &rigidbody2 = g_conductor.get_component<rigidbody>(entity2);
+    // Triggers only report the contact
+    if (rigidbody1.is_trigger || rigidbody2.is_trigger) {
+        return false;
+    }
+
+    // Check if the entities have moved
+    float lastX1 = transform1.last_position[0];
+    float lastY1 = transform1.last_position[1];
+    float x1 = transform1.position[0];
+    float y1 = transform1.position[1];
+    // Static bodies never give way
+    bool entity1Moved = !rigidbody1.is_static && (x1 != lastX1 || y1 != lastY1);
+
+    float lastX2 = transform2.last_position[0];
+    float lastY2 = transform2.last_position[1];
+    float x2 = transform2.position[0];
+    float y2 = transform2.position[1];
+    bool entity2Moved = !rigidbody2.is_static && (x2 != lastX2 || y2 != lastY2);
+
+    // Calculate actual size by multiplying base_size by scale
+    float w1 = rigidbody1.base_size[0] * transform1.scale[0];
+    float h1 = rigidbody1.base_size[1] * transform1.scale[1];
+    float w2 = rigidbody2.base_size[0] * transform2.scale[0];
+    float h2 = rigidbody2.base_size[1] * transform2.scale[1];
+
+    // Check if the two hitboxes intersect at current position. Earlier pairs
+    // may have moved either entity since the broad-phase, so test again
+    if (!rectanglesIntersect(x1, y1, w1, h1, x2, y2, w2, h2)) {
+        return false;
+    }
+    // Already overlapping at their last positions - only resolve if at least
+    // one entity has moved
+    if (was_colliding && !entity1Moved && !entity2Moved) {
+        return false;
+    }
+
+    // Calculate overlap of the rectangles at current position
+    float overlapLeft = (x1 + w1) - x2;
+    float overlapRight = (x2 + w2) - x1;
+    float overlapTop = (y1 + h1) - y2;
+    float overlapBottom = (y2 + h2) - y1;
+
+    // Find the minimum overlap (the axis of least penetration)
+    float minOverlapX = std::min(overlapLeft, overlapRight);
+    float minOverlapY = std::min(overlapTop, overlapBottom);
+
+    float totalMass = rigidbody1.Mass + rigidbody2.Mass;
+    if (totalMass <= 0.0f) {
+        return false;
+    }
+    float massRatio1 = rigidbody2.Mass / totalMass;
+    float massRatio2 = rigidbody1.Mass / totalMass;
+
+    // Prioritize vertical (Y-axis) collisions to prevent side clipping when falling,
+    // resolve on X axis only if Y-axis wasn't resolved
+    float minOverlap = 0.0f;
+    bool entity1First = false;
+    if (minOverlapY > 0.0f && (minOverlapY <= minOverlapX || minOverlapX <= 0.0f)) {
+        result.axis = 1;
+        minOverlap = minOverlapY;
+        // entity1 is on top
+        entity1First = overlapTop < overlapBottom;
+    } else if (minOverlapX > 0.0f) {
+        result.axis = 0;
+        minOverlap = minOverlapX;
+        // entity1 is on the left
+        entity1First = overlapLeft < overlapRight;
+    } else {
+        return false;
+    }
+
+    // Push entity1 back towards its side (up or left) and entity2 away from it
+    float separation1 = entity1First ? -minOverlap : minOverlap;
+    float separation2 = -separation1;
+    if (!was_colliding) {
+        // They weren't colliding before, so move them back towards last positions
+        if (entity1Moved && entity2Moved) {
+            // Both moved, separate based on how far each one moved
+            float moveX1 = x1 - lastX1;
+            float moveY1 = y1 - lastY1;
+            float moveX2 = x2 - lastX2;
+            float moveY2 = y2 - lastY2;
+            float moveMag1 = std::sqrt(moveX1 * moveX1 + moveY1 * moveY1);
+            float moveMag2 = std::sqrt(moveX2 * moveX2 + moveY2 * moveY2);
+            float moveRatio1 = moveMag1 / (moveMag1 + moveMag2);
+            float moveRatio2 = moveMag2 / (moveMag1 + moveMag2);
+            separation1 = separation1 * massRatio1 * moveRatio1;
+            separation2 = separation2 * massRatio2 * moveRatio2;
+        }
+        // Otherwise only the entity that moved is pushed back completely
+    } else {
+        // They were already colliding at last position, separate by mass
+        separation1 = separation1 * massRatio1;
+        separation2 = separation2 * massRatio2;
+    }
+
+    // Only apply separation to entities that have moved
+    result.entity1 = entity1;
+    result.entity2 = entity2;
+    result.separation1 = entity1Moved ? separation1 : 0.0f;
+    result.separation2 = entity2Moved ? separation2 : 0.0f;
+    return result.separation1 != 0.0f || result.separation2 != 0.0f;
+}
+
+std::uint8_t collision_detection_system::apply_contact(const contact &resolved) {
+    std::uint8_t landed = 0;
+    if (apply_separation(resolved.entity1, resolved.axis, resolved.separation1)) {
+        landed |= LANDED_FIRST;
+    }
+    if (apply_separation(resolved.entity2, resolved.axis, resolved.separation2)) {
+        landed |= LANDED_SECOND;
+    }
+    return landed;
+}
+
+bool collision_detection_system::apply_separation(entity ent, int axis, float separation) {
+    if (separation == 0.0f) {
+        return false;
+    }
+    auto &transform_comp = g_conductor.get_component<transform>(ent);
+    auto &rigidbody_comp = g_conductor.get_component<rigidbody>(ent);
+    transform_comp.position[axis] += separation;
+    // Update bounds to match the transform
+    rigidbody_comp.bounds.position[axis] = transform_comp.position[axis];
+
+    if (axis == 0) {
+        // Stop velocity in the collision direction
+        rigidbody_comp.velocity[0] = 0.0f;
+        return false;
+    }
+    // Stop velocity only if collision is in the direction of movement
+    // If moving up (negative velocity) and being pushed down (positive separation), reset
+    // If moving down (positive velocity) and being pushed up (negative separation), reset
+    if ((rigidbody_comp.velocity[1] < 0.0f && separation > 0.0f) ||
+        (rigidbody_comp.velocity[1] > 0.0f && separation < 0.0f)) {
+        // Landing: moving down and being pushed up
+        bool landed = rigidbody_comp.velocity[1] > 0.0f && separation < 0.0f;
+        rigidbody_comp.velocity[1] = 0.0f;
+        return landed;
     }
-}
\ No newline at end of file
+    return false;
+}
@@ -1,15 +1,23 @@
 #include "systems/jump_system.hpp"
 #include "components/jump.hpp"
-#include <algorithm>
 #include "components/entity_state.hpp"
+#include "systems/collision_detection_system.hpp"
 
 extern conductor g_conductor;
 
+void jump_system::update(const collision_detection_system& collisions) {
+    collisions.for_each_event(g_conductor.make_signature<jump>(), signature(), [this](const collision_event& event) {
+        if (event.phase != collision_phase::exit && event.landed1) {
+            reset_jump(event.entity1);
+        }
+    });
+}
+
 void jump_system::reset_jump(entity e) {
     auto& entity_state_comp = g_conductor.get_component<entity_state>(e);
     if (!entity_state_comp.is_active) {
         return;
     }
-    if (std::find(entities.begin(), entities.end(), e) == entities.end()) return;
+    if (!entities.contains(e)) return;
     g_conductor.get_component<jump>(e).is_jumping = false;
 }
\ No newline at end of file
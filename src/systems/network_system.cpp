@@ -1,4 +1,6 @@
 #include "systems/network_system.hpp"
+#include "bit_stream.hpp"
+#include "component_delta.hpp"
 #include "component_serialization.hpp"
 #include "components/entity_state.hpp"
 #include "components/gravity.hpp"
@@ -12,31 +14,56 @@
 #include "components/transform.hpp"
 #include "conductor.hpp"
 #include "entity.hpp"
+#include "entity_builder.hpp"
 #include "network_manager.hpp"
 #include "packets.hpp"
 #include <SFML/Graphics/Sprite.hpp>
 #include <SFML/Window/Keyboard.hpp>
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
 #include <steam/steamnetworkingtypes.h>
+#include <utility>
 #include <vector>
 
 extern conductor g_conductor;
 
+// Largest snapshot message, kept under a typical path MTU so the sockets
+// library sends each one as a single unfragmented datagram
+constexpr size_t SNAPSHOT_MTU = 1200;
+// Interest management (host only): entities further than INTEREST_RADIUS
+// from a client's player aren't sent to it. Closer than FULL_RATE_RADIUS
+// they're sent every tick they change; in between the rate falls off
+// linearly to MIN_PRIORITY of the ticks at the edge
+constexpr float INTEREST_RADIUS = 2000.0f;
+constexpr float FULL_RATE_RADIUS = 500.0f;
+constexpr float MIN_PRIORITY = 0.1f;
+
+namespace {
+// FNV-1a, to tell whether a component's serialized bytes changed without
+// keeping a copy of them per peer
+uint64_t hash_bytes(const std::vector<uint8_t> &bytes) {
+    uint64_t hash = 14695981039346656037ull;
+    for (uint8_t byte : bytes) {
+        hash ^= byte;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+} // namespace
+
 void network_system::update(float dt) {
     NetworkManager &nm = NetworkManager::Get();
     if (!nm.IsConnected())
         return;
 
-    if (nm.IsHost()) {
-        broadcast_state();
-        broadcast_component_updates();
-    } else {
+    if (!nm.IsHost()) {
         send_input();
-        send_component_updates();
         update_remote_entities(dt);
     }
+    send_component_snapshots();
 }
 
 void network_system::handle_packet(HSteamNetConnection conn, const void *data,
@@ -59,51 +86,21 @@ void network_system::handle_packet(HSteamNetConnection conn, const void *data,
     case PacketType::EntityInitPacket:
         handle_entity_init(data, size);
         break;
-    case PacketType::ComponentBatchUpdate:
-        handle_component_batch_update(data, size);
+    case PacketType::ComponentSnapshot:
+        handle_component_snapshot(conn, data, size);
         break;
     case PacketType::OwnershipTransferPacket:
         handle_ownership_transfer(data, size);
         break;
+    case PacketType::SnapshotAck:
+        handle_snapshot_ack(conn, data, size);
+        break;
     case PacketType::PlayerInput: {
         if (size < sizeof(PlayerInputPacket))
             return;
         // Handle player input from clients (host only)
         break;
     }
-    case PacketType::GameStateUpdate: {
-        if (size < sizeof(GameStateUpdatePacket))
-            return;
-        const GameStateUpdatePacket *packet =
-            static_cast<const GameStateUpdatePacket *>(data);
-
-        const uint8_t *ptr =
-            static_cast<const uint8_t *>(data) + sizeof(GameStateUpdatePacket);
-        for (uint32_t i = 0; i < packet->entity_count; ++i) {
-            if (ptr + sizeof(EntityStateData) >
-                static_cast<const uint8_t *>(data) + size)
-                break;
-            const EntityStateData *state =
-                reinterpret_cast<const EntityStateData *>(ptr);
-
-            for (auto const &entity : entities) {
-                auto &net = g_conductor.get_component<network>(entity);
-                if (net.id == state->entity_id && !net.is_local) {
-                    auto &trans = g_conductor.get_component<transform>(entity);
-                    trans.position[0] = state->position_x;
-                    trans.position[1] = state->position_y;
-
-                    auto &rb = g_conductor.get_component<rigidbody>(entity);
-                    rb.velocity[0] = state->velocity_x;
-                    rb.velocity[1] = state->velocity_y;
-                    break;
-                }
-            }
-
-            ptr += sizeof(EntityStateData);
-        }
-        break;
-    }
     default:
         break;
     }
@@ -428,28 +425,25 @@ void network_system::handle_entity_init(const void *data, size_t size) {
 
     // Check if entity already exists (prevent duplicates)
     entity existing_ent = NetworkManager::Get().GetEntityByNetworkId(header->network_id);
-    if (existing_ent != 0) {
+    if (existing_ent != NULL_ENTITY) {
         return;
     }
 
-    // Create the entity with network component
-    // The entity is remote (not local) since we're receiving it
-    entity ent = create_networked_entity(header->network_id, false);
-
     // Read the networked components list
     const uint8_t *ptr =
         static_cast<const uint8_t *>(data) + sizeof(EntityInitPacketHeader);
 
-    auto &net_comp = g_conductor.get_component<network>(ent);
-    net_comp.networked_components.clear();
+    std::vector<ComponentID> networked_components;
     for (uint8_t i = 0; i < header->networked_component_count; ++i) {
         if (ptr >= static_cast<const uint8_t *>(data) + size)
             break;
         ComponentID comp_id = static_cast<ComponentID>(*ptr++);
-        net_comp.networked_components.push_back(comp_id);
+        networked_components.push_back(comp_id);
     }
 
-    // Deserialize components
+    // Deserialize components into a builder so the entity is spawned with
+    // its final signature in one step
+    entity_builder builder;
     auto &serializer = ComponentSerializer::Get();
 
     for (uint32_t i = 0; i < header->component_count; ++i) {
@@ -469,13 +463,13 @@ void network_system::handle_entity_init(const void *data, size_t size) {
         switch (comp_id) {
         case ComponentID::Transform: {
             transform trans = serializer.Deserialize<transform>(ptr, comp_size);
-            g_conductor.add_component<transform>(ent, trans);
+            builder.with(trans);
             break;
         }
         case ComponentID::Rigidbody: {
             rigidbody rb =
                 serializer.DeserializeCustom<rigidbody>(ptr, comp_size);
-            g_conductor.add_component<rigidbody>(ent, rb);
+            builder.with(rb);
             break;
         }
         case ComponentID::Sprite: {
@@ -489,39 +483,39 @@ void network_system::handle_entity_init(const void *data, size_t size) {
                     spr.sprite_obj = sf::Sprite(spr.texture);
                 }
             }
-            g_conductor.add_component<sprite>(ent, spr);
+            builder.with(spr);
             break;
         }
         case ComponentID::Gravity: {
             gravity grav = serializer.Deserialize<gravity>(ptr, comp_size);
-            g_conductor.add_component<gravity>(ent, grav);
+            builder.with(grav);
             break;
         }
         case ComponentID::Jump: {
             jump jmp = serializer.Deserialize<jump>(ptr, comp_size);
-            g_conductor.add_component<jump>(ent, jmp);
+            builder.with(jmp);
             break;
         }
         case ComponentID::Inventory: {
             inventory inv =
                 serializer.DeserializeCustom<inventory>(ptr, comp_size);
-            g_conductor.add_component<inventory>(ent, inv);
+            builder.with(inv);
             break;
         }
         case ComponentID::Item: {
             item itm = serializer.DeserializeCustom<item>(ptr, comp_size);
-            g_conductor.add_component<item>(ent, itm);
+            builder.with(itm);
             break;
         }
         case ComponentID::Player: {
             player plr = serializer.Deserialize<player>(ptr, comp_size);
-            g_conductor.add_component<player>(ent, plr);
+            builder.with(plr);
             break;
         }
         case ComponentID::EntityState: {
             entity_state state =
                 serializer.Deserialize<entity_state>(ptr, comp_size);
-            g_conductor.add_component<entity_state>(ent, state);
+            builder.with(state);
             break;
         }
         default:
@@ -532,10 +526,17 @@ void network_system::handle_entity_init(const void *data, size_t size) {
     }
 
     // Ensure entity_state component exists (required for most systems)
-    if (!g_conductor.has_component<entity_state>(ent)) {
-        g_conductor.add_component<entity_state>(ent, entity_state{true, false});
+    if (!builder.has<entity_state>()) {
+        builder.with(entity_state{true, false});
     }
 
+    // Create the entity with network component
+    // The entity is remote (not local) since we're receiving it
+    entity ent = g_conductor.create_networked_entity(header->network_id, false,
+                                                     std::move(builder));
+    g_conductor.get_component<network>(ent).networked_components =
+        std::move(networked_components);
+
     std::cout << "Created networked entity with ID " << header->network_id << std::endl;
 
     // If we're the host, forward this to other clients
@@ -552,7 +553,7 @@ void network_system::handle_ownership_transfer(const void *data, size_t size) {
         static_cast<const OwnershipTransferPacketData *>(data);
 
     entity ent = NetworkManager::Get().GetEntityByNetworkId(packet->network_id);
-    if (ent == 0)
+    if (ent == NULL_ENTITY)
         return;
 
     auto &net = g_conductor.get_component<network>(ent);
@@ -565,67 +566,165 @@ void network_system::handle_ownership_transfer(const void *data, size_t size) {
         net.is_local = false;
     }
 
+    // Updates for it come from the new owner now, so start over with every
+    // peer rather than trusting who owned it before
+    entity index = entity_index(ent);
+    for (auto &[conn, peer] : m_peers) {
+        if (index < peer.baselines.size() && peer.baselines[index].ent == ent) {
+            peer.baselines[index] = entity_baseline{};
+        }
+    }
+
     // If we're the host, broadcast this to all clients
     if (NetworkManager::Get().IsHost()) {
         NetworkManager::Get().BroadcastPacket(data, size);
     }
 }
 
-void network_system::handle_component_batch_update(const void *data,
-                                                   size_t size) {
-    if (size < sizeof(ComponentBatchUpdatePacket))
+void network_system::handle_component_snapshot(HSteamNetConnection conn,
+                                               const void *data, size_t size) {
+    if (size < sizeof(ComponentSnapshotPacket))
         return;
 
-    const ComponentBatchUpdatePacket *packet =
-        static_cast<const ComponentBatchUpdatePacket *>(data);
+    const ComponentSnapshotPacket *packet =
+        static_cast<const ComponentSnapshotPacket *>(data);
+    peer_replication &peer = m_peers[conn];
 
-    entity ent = NetworkManager::Get().GetEntityByNetworkId(packet->network_id);
-    if (ent == 0)
+    // A snapshot arriving after a newer one would roll entities back; it's
+    // dropped (and never acked), so whatever it carried is sent again
+    uint32_t sequence = packet->header.sequence_number;
+    if (peer.received_sequence != 0 && sequence <= peer.received_sequence)
         return;
+    uint32_t shift = sequence - peer.received_sequence;
+    if (peer.received_sequence == 0 || shift > 32) {
+        peer.received_mask = 0;
+    } else {
+        peer.received_mask = (shift == 32 ? 0 : peer.received_mask << shift) | (1u << (shift - 1));
+    }
+    peer.received_sequence = sequence;
+    peer.ack_pending = true;
 
-    auto &net = g_conductor.get_component<network>(ent);
-    if (net.is_local)
-        return; // Don't apply updates to local entities
-
-    // Deserialize components
     const uint8_t *ptr =
-        static_cast<const uint8_t *>(data) + sizeof(ComponentBatchUpdatePacket);
-    auto &serializer = ComponentSerializer::Get();
+        static_cast<const uint8_t *>(data) + sizeof(ComponentSnapshotPacket);
+    const uint8_t *end = static_cast<const uint8_t *>(data) + size;
 
-    for (uint32_t i = 0; i < packet->component_count; ++i) {
-        if (ptr + 3 > static_cast<const uint8_t *>(data) + size)
+    for (uint16_t i = 0; i < packet->entity_count; ++i) {
+        if (end - ptr < static_cast<ptrdiff_t>(sizeof(ComponentSnapshotEntry)))
+            break;
+        const ComponentSnapshotEntry *entry =
+            reinterpret_cast<const ComponentSnapshotEntry *>(ptr);
+        ptr += sizeof(ComponentSnapshotEntry);
+        if (end - ptr < static_cast<ptrdiff_t>(entry->size))
             break;
 
-        uint8_t comp_id_raw = *ptr++;
-        uint16_t comp_size = *ptr++;
-        comp_size |= (static_cast<uint16_t>(*ptr++) << 8);
+        // Entities that aren't initialized here yet are skipped, as are our
+        // own (don't apply updates to local entities)
+        entity ent = NetworkManager::Get().GetEntityByNetworkId(entry->network_id);
+        if (ent != NULL_ENTITY && !g_conductor.get_component<network>(ent).is_local) {
+            BitReader reader(ptr, entry->size);
+            read_component_updates(ent, entry->component_count, reader);
+
+            // The peer owns this entity: the host relays its state to the
+            // other clients, but never back to the peer
+            entity index = entity_index(ent);
+            if (index >= peer.baselines.size()) {
+                peer.baselines.resize(index + 1);
+            }
+            if (peer.baselines[index].ent != ent) {
+                peer.baselines[index] = entity_baseline{};
+                peer.baselines[index].ent = ent;
+            }
+            peer.baselines[index].owned_by_peer = true;
+            if (NetworkManager::Get().IsHost() && g_conductor.has_component<player>(ent)) {
+                peer.focus = ent;
+            }
+        }
+        ptr += entry->size;
+    }
+}
 
-        if (ptr + comp_size > static_cast<const uint8_t *>(data) + size)
-            break;
+void network_system::handle_snapshot_ack(HSteamNetConnection conn,
+                                         const void *data, size_t size) {
+    if (size < sizeof(SnapshotAckPacket))
+        return;
 
-        ComponentID comp_id = static_cast<ComponentID>(comp_id_raw);
+    const SnapshotAckPacket *packet =
+        static_cast<const SnapshotAckPacket *>(data);
+    auto peer_it = m_peers.find(conn);
+    if (peer_it == m_peers.end())
+        return;
+    peer_replication &peer = peer_it->second;
+
+    // Oldest first, so a baseline ends up with the newest acked state.
+    // Snapshots acked before (or no longer in the history) are skipped
+    for (int bit = 31; bit >= -1; --bit) {
+        if (bit >= 0 && (packet->received_mask & (1u << bit)) == 0)
+            continue;
+        uint32_t sequence = packet->latest_sequence - 1 - bit;
+        sent_snapshot &snapshot = peer.history[sequence % SNAPSHOT_HISTORY];
+        if (snapshot.pending && snapshot.sequence == sequence) {
+            apply_snapshot_ack(peer, snapshot);
+        }
+    }
+}
 
-        // Deserialize and apply based on component ID
-        switch (comp_id) {
-        case ComponentID::Transform: {
-            transform trans = serializer.Deserialize<transform>(ptr, comp_size);
-            if (g_conductor.has_component<transform>(ent)) {
+void network_system::read_component_updates(entity ent, uint32_t component_count,
+                                            BitReader &reader) {
+    auto &serializer = ComponentSerializer::Get();
+    std::vector<uint8_t> component_data;
+
+    for (uint32_t i = 0; i < component_count; ++i) {
+        ComponentID comp_id = static_cast<ComponentID>(reader.ReadBits(COMPONENT_ID_BITS));
+        if (reader.HasOverflowed())
+            break;
+
+        // Transform and rigidbody deltas only carry the changed fields, which
+        // are applied on top of the entity's copy. Components the entity
+        // lacks are added at the next sync point, not mid-update
+        if (comp_id == ComponentID::Transform) {
+            bool has_transform = g_conductor.has_component<transform>(ent);
+            transform trans = has_transform ? g_conductor.get_component<transform>(ent)
+                                            : transform{{0.0f, 0.0f}, {0.0f, 0.0f}, {1.0f, 1.0f}};
+            ReadTransformDelta(reader, trans);
+            if (reader.HasOverflowed())
+                break;
+            if (has_transform) {
                 g_conductor.get_component<transform>(ent) = trans;
+                // Moved by its owner, so it's no longer resting here
+                if (g_conductor.has_component<rigidbody>(ent)) {
+                    wake(g_conductor.get_component<rigidbody>(ent));
+                }
             } else {
-                g_conductor.add_component<transform>(ent, trans);
+                g_conductor.commands().add_component<transform>(ent, trans);
             }
-            break;
+            continue;
         }
-        case ComponentID::Rigidbody: {
-            rigidbody rb =
-                serializer.DeserializeCustom<rigidbody>(ptr, comp_size);
-            if (g_conductor.has_component<rigidbody>(ent)) {
+        if (comp_id == ComponentID::Rigidbody) {
+            bool has_rigidbody = g_conductor.has_component<rigidbody>(ent);
+            rigidbody rb = has_rigidbody ? g_conductor.get_component<rigidbody>(ent) : rigidbody{};
+            bool velocity_changed = ReadRigidbodyDelta(reader, rb);
+            if (reader.HasOverflowed())
+                break;
+            if (velocity_changed) {
+                wake(rb);
+            }
+            if (has_rigidbody) {
                 g_conductor.get_component<rigidbody>(ent) = rb;
             } else {
-                g_conductor.add_component<rigidbody>(ent, rb);
+                g_conductor.commands().add_component<rigidbody>(ent, rb);
             }
-            break;
+            continue;
         }
+
+        // Other components are sent whole: [size][data]
+        uint16_t comp_size = static_cast<uint16_t>(reader.ReadBits(16));
+        component_data.resize(comp_size);
+        if (!reader.ReadBytes(component_data.data(), comp_size))
+            break;
+        const uint8_t *ptr = component_data.data();
+
+        // Deserialize and apply based on component ID
+        switch (comp_id) {
         case ComponentID::Sprite: {
             sprite spr = serializer.DeserializeCustom<sprite>(ptr, comp_size);
             // Load texture from texture_name
@@ -640,7 +739,7 @@ void network_system::handle_component_batch_update(const void *data,
             if (g_conductor.has_component<sprite>(ent)) {
                 g_conductor.get_component<sprite>(ent) = spr;
             } else {
-                g_conductor.add_component<sprite>(ent, spr);
+                g_conductor.commands().add_component<sprite>(ent, spr);
             }
             break;
         }
@@ -649,7 +748,7 @@ void network_system::handle_component_batch_update(const void *data,
             if (g_conductor.has_component<gravity>(ent)) {
                 g_conductor.get_component<gravity>(ent) = grav;
             } else {
-                g_conductor.add_component<gravity>(ent, grav);
+                g_conductor.commands().add_component<gravity>(ent, grav);
             }
             break;
         }
@@ -658,7 +757,7 @@ void network_system::handle_component_batch_update(const void *data,
             if (g_conductor.has_component<jump>(ent)) {
                 g_conductor.get_component<jump>(ent) = jmp;
             } else {
-                g_conductor.add_component<jump>(ent, jmp);
+                g_conductor.commands().add_component<jump>(ent, jmp);
             }
             break;
         }
@@ -668,7 +767,7 @@ void network_system::handle_component_batch_update(const void *data,
             if (g_conductor.has_component<inventory>(ent)) {
                 g_conductor.get_component<inventory>(ent) = inv;
             } else {
-                g_conductor.add_component<inventory>(ent, inv);
+                g_conductor.commands().add_component<inventory>(ent, inv);
             }
             break;
         }
@@ -677,7 +776,7 @@ void network_system::handle_component_batch_update(const void *data,
             if (g_conductor.has_component<item>(ent)) {
                 g_conductor.get_component<item>(ent) = itm;
             } else {
-                g_conductor.add_component<item>(ent, itm);
+                g_conductor.commands().add_component<item>(ent, itm);
             }
             break;
         }
@@ -686,7 +785,7 @@ void network_system::handle_component_batch_update(const void *data,
             if (g_conductor.has_component<player>(ent)) {
                 g_conductor.get_component<player>(ent) = plr;
             } else {
-                g_conductor.add_component<player>(ent, plr);
+                g_conductor.commands().add_component<player>(ent, plr);
             }
             break;
         }
@@ -696,222 +795,99 @@ void network_system::handle_component_batch_update(const void *data,
             if (g_conductor.has_component<entity_state>(ent)) {
                 g_conductor.get_component<entity_state>(ent) = state;
             } else {
-                g_conductor.add_component<entity_state>(ent, state);
+                g_conductor.commands().add_component<entity_state>(ent, state);
             }
             break;
         }
         default:
             break;
         }
-
-        ptr += comp_size;
-    }
-
-    // If we're the host, forward this to other clients
-    if (NetworkManager::Get().IsHost()) {
-        NetworkManager::Get().BroadcastPacket(data, size,
-                                              k_nSteamNetworkingSend_Unreliable);
     }
 }
 
 // Network sync methods
-bool network_system::has_component_changed(entity ent, ComponentID comp_id,
-                                           const std::vector<uint8_t> &current_data) {
-    auto entity_it = m_lastSentComponentData.find(ent);
-    if (entity_it == m_lastSentComponentData.end()) {
-        return true; // No previous data, consider it changed
-    }
+void network_system::send_component_snapshots() {
+    NetworkManager &nm = NetworkManager::Get();
+    std::vector<HSteamNetConnection> connections = nm.GetPeerConnections();
 
-    auto comp_it = entity_it->second.find(comp_id);
-    if (comp_it == entity_it->second.end()) {
-        return true; // No previous data for this component
+    // Forget the peers that disconnected
+    for (auto it = m_peers.begin(); it != m_peers.end();) {
+        if (std::find(connections.begin(), connections.end(), it->first) == connections.end()) {
+            it = m_peers.erase(it);
+        } else {
+            ++it;
+        }
     }
 
-    // Compare the data
-    return comp_it->second != current_data;
+    capture_entities();
+    for (HSteamNetConnection conn : connections) {
+        peer_replication &peer = m_peers[conn];
+
+        build_snapshots(peer);
+        for (auto const &snapshot : m_snapshots) {
+            nm.QueueMessage(conn, snapshot.data(), snapshot.size(),
+                            k_nSteamNetworkingSend_Unreliable);
+        }
+
+        if (peer.ack_pending) {
+            SnapshotAckPacket ack;
+            ack.header.type = PacketType::SnapshotAck;
+            ack.header.sequence_number = 0;
+            ack.latest_sequence = peer.received_sequence;
+            ack.received_mask = peer.received_mask;
+            nm.QueueMessage(conn, &ack, sizeof(ack), k_nSteamNetworkingSend_Unreliable);
+            peer.ack_pending = false;
+        }
+    }
+    nm.FlushMessages();
 }
 
-void network_system::broadcast_component_updates() {
+void network_system::capture_entities() {
     auto &serializer = ComponentSerializer::Get();
+    // The host relays the entities its clients own to the other clients
+    bool relay_remote = NetworkManager::Get().IsHost();
+
+    m_tickEntities.clear();
+    m_tickComponents.clear();
+    m_tickComponentBytes.clear();
 
     for (auto const &ent : entities) {
         auto &net = g_conductor.get_component<network>(ent);
-        if (!net.is_local)
+        if (!net.is_local && !relay_remote)
             continue; // Only send local entities
+        // Sleeping bodies are captured too: a peer may not have acked their
+        // final state (or was out of range), and once it has nothing is sent
 
-        // Build buffer for this entity's component updates
-        std::vector<uint8_t> buffer;
-        buffer.resize(sizeof(ComponentBatchUpdatePacket));
-
-        ComponentBatchUpdatePacket *header =
-            reinterpret_cast<ComponentBatchUpdatePacket *>(buffer.data());
-        header->header.type = PacketType::ComponentBatchUpdate;
-        header->header.sequence_number = 0;
-        header->network_id = net.id;
-        header->component_count = 0;
-
-        // Track component count separately to avoid pointer invalidation
-        uint32_t component_count = 0;
+        replicated_entity current{};
+        current.ent = ent;
+        current.network_id = net.id;
+        current.first_component = static_cast<uint32_t>(m_tickComponents.size());
 
         // Iterate through networked components
         for (ComponentID comp_id : net.networked_components) {
-            std::vector<uint8_t> serialized_data;
-            bool has_component = false;
-
-            // Serialize based on component type
-            switch (comp_id) {
-            case ComponentID::Transform:
+            // Transform and rigidbody change nearly every frame, so only their
+            // fields that changed are sent, quantized
+            if (comp_id == ComponentID::Transform) {
                 if (g_conductor.has_component<transform>(ent)) {
-                    auto &comp = g_conductor.get_component<transform>(ent);
-                    SerializedComponent sc = serializer.Serialize(comp, comp_id);
-                    serialized_data = sc.data;
-                    has_component = true;
+                    current.transform = QuantizeTransform(g_conductor.get_component<transform>(ent));
+                    current.has_transform = true;
                 }
-                break;
-            case ComponentID::Rigidbody:
+                continue;
+            }
+            if (comp_id == ComponentID::Rigidbody) {
                 if (g_conductor.has_component<rigidbody>(ent)) {
-                    auto &comp = g_conductor.get_component<rigidbody>(ent);
-                    SerializedComponent sc = serializer.SerializeCustom(comp);
-                    serialized_data = sc.data;
-                    has_component = true;
-                }
-                break;
-            case ComponentID::Sprite:
-                if (g_conductor.has_component<sprite>(ent)) {
-                    auto &comp = g_conductor.get_component<sprite>(ent);
-                    SerializedComponent sc = serializer.SerializeCustom(comp);
-                    serialized_data = sc.data;
-                    has_component = true;
-                }
-                break;
-            case ComponentID::Gravity:
-                if (g_conductor.has_component<gravity>(ent)) {
-                    auto &comp = g_conductor.get_component<gravity>(ent);
-                    SerializedComponent sc = serializer.Serialize(comp, comp_id);
-                    serialized_data = sc.data;
-                    has_component = true;
-                }
-                break;
-            case ComponentID::Jump:
-                if (g_conductor.has_component<jump>(ent)) {
-                    auto &comp = g_conductor.get_component<jump>(ent);
-                    SerializedComponent sc = serializer.Serialize(comp, comp_id);
-                    serialized_data = sc.data;
-                    has_component = true;
+                    current.rigidbody = QuantizeRigidbody(g_conductor.get_component<rigidbody>(ent));
+                    current.has_rigidbody = true;
                 }
-                break;
-            case ComponentID::Inventory:
-                if (g_conductor.has_component<inventory>(ent)) {
-                    auto &comp = g_conductor.get_component<inventory>(ent);
-                    SerializedComponent sc = serializer.SerializeCustom(comp);
-                    serialized_data = sc.data;
-                    has_component = true;
-                }
-                break;
-            case ComponentID::Item:
-                if (g_conductor.has_component<item>(ent)) {
-                    auto &comp = g_conductor.get_component<item>(ent);
-                    SerializedComponent sc = serializer.SerializeCustom(comp);
-                    serialized_data = sc.data;
-                    has_component = true;
-                }
-                break;
-            case ComponentID::Player:
-                if (g_conductor.has_component<player>(ent)) {
-                    auto &comp = g_conductor.get_component<player>(ent);
-                    SerializedComponent sc = serializer.Serialize(comp, comp_id);
-                    serialized_data = sc.data;
-                    has_component = true;
-                }
-                break;
-            case ComponentID::EntityState:
-                if (g_conductor.has_component<entity_state>(ent)) {
-                    auto &comp = g_conductor.get_component<entity_state>(ent);
-                    SerializedComponent sc = serializer.Serialize(comp, comp_id);
-                    serialized_data = sc.data;
-                    has_component = true;
-                }
-                break;
-            default:
-                break;
-            }
-
-            // Check if component changed
-            if (has_component && has_component_changed(ent, comp_id, serialized_data)) {
-                // Add to buffer: [comp_id][size][data]
-                uint8_t comp_id_raw = static_cast<uint8_t>(comp_id);
-                uint16_t comp_size = static_cast<uint16_t>(serialized_data.size());
-
-                buffer.push_back(comp_id_raw);
-                buffer.push_back(comp_size & 0xFF);
-                buffer.push_back((comp_size >> 8) & 0xFF);
-                buffer.insert(buffer.end(), serialized_data.begin(), serialized_data.end());
-
-                component_count++;
-
-                // Update last sent data
-                m_lastSentComponentData[ent][comp_id] = serialized_data;
+                continue;
             }
-        }
-
-        // Send packet if there are changes
-        if (component_count > 0) {
-            // Update header with final component count (use fresh pointer after all buffer modifications)
-            ComponentBatchUpdatePacket *final_header =
-                reinterpret_cast<ComponentBatchUpdatePacket *>(buffer.data());
-            final_header->component_count = component_count;
 
-            NetworkManager::Get().BroadcastPacket(buffer.data(), buffer.size(),
-                                                  k_nSteamNetworkingSend_Unreliable);
-        }
-    }
-}
-
-void network_system::send_component_updates() {
-    auto &serializer = ComponentSerializer::Get();
-
-    for (auto const &ent : entities) {
-        auto &net = g_conductor.get_component<network>(ent);
-        if (!net.is_local)
-            continue; // Only send local entities
-
-        // Build buffer for this entity's component updates
-        std::vector<uint8_t> buffer;
-        buffer.resize(sizeof(ComponentBatchUpdatePacket));
-
-        ComponentBatchUpdatePacket *header =
-            reinterpret_cast<ComponentBatchUpdatePacket *>(buffer.data());
-        header->header.type = PacketType::ComponentBatchUpdate;
-        header->header.sequence_number = 0;
-        header->network_id = net.id;
-        header->component_count = 0;
-
-        // Track component count separately to avoid pointer invalidation
-        uint32_t component_count = 0;
-
-        // Iterate through networked components
-        for (ComponentID comp_id : net.networked_components) {
+            // Other components are sent whole when they change
             std::vector<uint8_t> serialized_data;
             bool has_component = false;
 
             // Serialize based on component type
             switch (comp_id) {
-            case ComponentID::Transform:
-                if (g_conductor.has_component<transform>(ent)) {
-                    auto &comp = g_conductor.get_component<transform>(ent);
-                    SerializedComponent sc = serializer.Serialize(comp, comp_id);
-                    serialized_data = sc.data;
-                    has_component = true;
-                }
-                break;
-            case ComponentID::Rigidbody:
-                if (g_conductor.has_component<rigidbody>(ent)) {
-                    auto &comp = g_conductor.get_component<rigidbody>(ent);
-                    SerializedComponent sc = serializer.SerializeCustom(comp);
-                    serialized_data = sc.data;
-                    has_component = true;
-                }
-                break;
             case ComponentID::Sprite:
                 if (g_conductor.has_component<sprite>(ent)) {
                     auto &comp = g_conductor.get_component<sprite>(ent);
@@ -972,79 +948,205 @@ void network_system::send_component_updates() {
                 break;
             }
 
-            // Check if component changed
-            if (has_component && has_component_changed(ent, comp_id, serialized_data)) {
-                // Add to buffer: [comp_id][size][data]
-                uint8_t comp_id_raw = static_cast<uint8_t>(comp_id);
-                uint16_t comp_size = static_cast<uint16_t>(serialized_data.size());
-
-                buffer.push_back(comp_id_raw);
-                buffer.push_back(comp_size & 0xFF);
-                buffer.push_back((comp_size >> 8) & 0xFF);
-                buffer.insert(buffer.end(), serialized_data.begin(), serialized_data.end());
-
-                component_count++;
-
-                // Update last sent data
-                m_lastSentComponentData[ent][comp_id] = serialized_data;
+            if (has_component) {
+                replicated_component comp;
+                comp.id = comp_id;
+                comp.hash = hash_bytes(serialized_data);
+                comp.offset = static_cast<uint32_t>(m_tickComponentBytes.size());
+                comp.size = static_cast<uint32_t>(serialized_data.size());
+                m_tickComponentBytes.insert(m_tickComponentBytes.end(),
+                                            serialized_data.begin(), serialized_data.end());
+                m_tickComponents.push_back(comp);
             }
         }
 
-        // Send packet to host if there are changes
-        if (component_count > 0) {
-            // Update header with final component count (use fresh pointer after all buffer modifications)
-            ComponentBatchUpdatePacket *final_header =
-                reinterpret_cast<ComponentBatchUpdatePacket *>(buffer.data());
-            final_header->component_count = component_count;
-
-            NetworkManager::Get().SendPacketToServer(buffer.data(), buffer.size(),
-                                                     k_nSteamNetworkingSend_Unreliable);
-        }
+        current.component_count =
+            static_cast<uint32_t>(m_tickComponents.size()) - current.first_component;
+        m_tickEntities.push_back(current);
     }
 }
 
-// Old methods (kept for compatibility)
-void network_system::broadcast_state() {
-    std::vector<uint8_t> buffer;
-    buffer.resize(sizeof(GameStateUpdatePacket) +
-                  entities.size() * sizeof(EntityStateData));
+void network_system::build_snapshots(peer_replication &peer) {
+    m_snapshots.clear();
+    sent_snapshot *record = nullptr;
+
+    // Until its player is known (and on clients, whose only peer is the
+    // host) everything is relevant
+    bool has_focus = peer.focus != NULL_ENTITY && g_conductor.is_alive(peer.focus) &&
+                     g_conductor.has_component<transform>(peer.focus);
+    float focus[2] = {0.0f, 0.0f};
+    if (has_focus) {
+        auto &trans = g_conductor.get_component<transform>(peer.focus);
+        focus[0] = trans.position[0];
+        focus[1] = trans.position[1];
+    }
 
-    GameStateUpdatePacket *packet =
-        reinterpret_cast<GameStateUpdatePacket *>(buffer.data());
-    packet->header.type = PacketType::GameStateUpdate;
-    packet->header.sequence_number = 0;
-    packet->entity_count = 0;
+    for (const replicated_entity &current : m_tickEntities) {
+        entity index = entity_index(current.ent);
+        const entity_baseline *baseline = nullptr;
+        if (index < peer.baselines.size() && peer.baselines[index].ent == current.ent) {
+            baseline = &peer.baselines[index];
+            if (baseline->owned_by_peer)
+                continue;
+        }
 
-    uint8_t *ptr = buffer.data() + sizeof(GameStateUpdatePacket);
+        // Entities without a position are always relevant
+        float *priority = nullptr;
+        if (has_focus && current.has_transform) {
+            float dx = current.transform.position[0] / NET_POSITION_SCALE - focus[0];
+            float dy = current.transform.position[1] / NET_POSITION_SCALE - focus[1];
+            float distance = std::sqrt(dx * dx + dy * dy);
+            if (distance > INTEREST_RADIUS)
+                continue;
+
+            if (index >= peer.priorities.size()) {
+                peer.priorities.resize(index + 1, 1.0f);
+            }
+            priority = &peer.priorities[index];
+            float t = std::max(distance - FULL_RATE_RADIUS, 0.0f) / (INTEREST_RADIUS - FULL_RATE_RADIUS);
+            *priority += 1.0f - t * (1.0f - MIN_PRIORITY);
+            if (*priority < 1.0f)
+                continue;
+        }
 
-    for (auto const &entity : entities) {
-        auto &net = g_conductor.get_component<network>(entity);
-        if (net.is_local) { // Only send authoritative entities
-            packet->entity_count++;
-            EntityStateData *data = reinterpret_cast<EntityStateData *>(ptr);
-            data->entity_id = net.id;
+        m_entityUpdate.clear();
+        m_entityComponents.clear();
+        BitWriter writer(m_entityUpdate);
+        sent_entity sent{};
+        uint32_t component_count = write_component_updates(current, baseline, sent, writer);
+        if (component_count == 0) {
+            // Nothing changed: hold its turn so the next change goes out at once
+            if (priority) {
+                *priority = 1.0f;
+            }
+            continue;
+        }
+        writer.Flush();
+        if (priority) {
+            *priority -= 1.0f;
+        }
 
-            auto &trans = g_conductor.get_component<transform>(entity);
-            data->position_x = trans.position[0];
-            data->position_y = trans.position[1];
+        // Start a new message when this entity doesn't fit in the current
+        // one. An entity larger than SNAPSHOT_MTU on its own still goes in a
+        // single message, which the sockets library fragments
+        size_t entry_size = sizeof(ComponentSnapshotEntry) + m_entityUpdate.size();
+        if (m_snapshots.empty() ||
+            (m_snapshots.back().size() > sizeof(ComponentSnapshotPacket) &&
+             m_snapshots.back().size() + entry_size > SNAPSHOT_MTU)) {
+            uint32_t sequence = peer.next_sequence++;
+            std::vector<uint8_t> &snapshot = m_snapshots.emplace_back(sizeof(ComponentSnapshotPacket));
+            ComponentSnapshotPacket *header =
+                reinterpret_cast<ComponentSnapshotPacket *>(snapshot.data());
+            header->header.type = PacketType::ComponentSnapshot;
+            header->header.sequence_number = sequence;
+            header->entity_count = 0;
+
+            // Overwrites the oldest message, whose ack is too late to use now
+            record = &peer.history[sequence % SNAPSHOT_HISTORY];
+            record->sequence = sequence;
+            record->pending = true;
+            record->entities.clear();
+            record->components.clear();
+        }
 
-            auto &rb = g_conductor.get_component<rigidbody>(entity);
-            data->velocity_x = rb.velocity[0];
-            data->velocity_y = rb.velocity[1];
+        std::vector<uint8_t> &snapshot = m_snapshots.back();
+        ComponentSnapshotEntry entry;
+        entry.network_id = current.network_id;
+        entry.component_count = static_cast<uint8_t>(component_count);
+        entry.size = static_cast<uint16_t>(m_entityUpdate.size());
+        const uint8_t *entry_bytes = reinterpret_cast<const uint8_t *>(&entry);
+        snapshot.insert(snapshot.end(), entry_bytes, entry_bytes + sizeof(entry));
+        snapshot.insert(snapshot.end(), m_entityUpdate.begin(), m_entityUpdate.end());
+        reinterpret_cast<ComponentSnapshotPacket *>(snapshot.data())->entity_count++;
+
+        sent.first_component = static_cast<uint32_t>(record->components.size());
+        record->components.insert(record->components.end(), m_entityComponents.begin(),
+                                  m_entityComponents.end());
+        record->entities.push_back(sent);
+    }
+}
 
-            ptr += sizeof(EntityStateData);
+uint32_t network_system::write_component_updates(const replicated_entity &current,
+                                                 const entity_baseline *baseline,
+                                                 sent_entity &sent, BitWriter &writer) {
+    uint32_t component_count = 0;
+    sent.ent = current.ent;
+    sent.transform_dirty = 0;
+    sent.rigidbody_dirty = 0;
+    sent.component_count = 0;
+
+    if (current.has_transform) {
+        uint32_t dirty = TransformDirtyFields(
+            current.transform, baseline && baseline->has_transform ? &baseline->transform : nullptr);
+        if (dirty != 0) {
+            writer.WriteBits(static_cast<uint32_t>(ComponentID::Transform), COMPONENT_ID_BITS);
+            WriteTransformDelta(writer, current.transform, dirty);
+            sent.transform_dirty = dirty;
+            sent.transform = current.transform;
+            component_count++;
+        }
+    }
+    if (current.has_rigidbody) {
+        uint32_t dirty = RigidbodyDirtyFields(
+            current.rigidbody, baseline && baseline->has_rigidbody ? &baseline->rigidbody : nullptr);
+        if (dirty != 0) {
+            writer.WriteBits(static_cast<uint32_t>(ComponentID::Rigidbody), COMPONENT_ID_BITS);
+            WriteRigidbodyDelta(writer, current.rigidbody, dirty);
+            sent.rigidbody_dirty = dirty;
+            sent.rigidbody = current.rigidbody;
+            component_count++;
         }
     }
 
-    if (packet->entity_count > 0) {
-        NetworkManager::Get().BroadcastPacket(
-            buffer.data(),
-            sizeof(GameStateUpdatePacket) +
-                packet->entity_count * sizeof(EntityStateData),
-            k_nSteamNetworkingSend_Unreliable);
+    for (uint32_t i = 0; i < current.component_count; ++i) {
+        const replicated_component &comp = m_tickComponents[current.first_component + i];
+        uint32_t bit = 1u << static_cast<uint32_t>(comp.id);
+        if (baseline && (baseline->component_mask & bit) != 0 &&
+            baseline->component_hashes[static_cast<size_t>(comp.id)] == comp.hash)
+            continue;
+
+        // Add to stream: [comp_id][size][data]
+        writer.WriteBits(static_cast<uint32_t>(comp.id), COMPONENT_ID_BITS);
+        writer.WriteBits(comp.size, 16);
+        writer.WriteBytes(m_tickComponentBytes.data() + comp.offset, comp.size);
+        m_entityComponents.emplace_back(comp.id, comp.hash);
+        component_count++;
     }
+    sent.component_count = static_cast<uint32_t>(m_entityComponents.size());
+    return component_count;
 }
 
+void network_system::apply_snapshot_ack(peer_replication &peer, sent_snapshot &snapshot) {
+    for (const sent_entity &sent : snapshot.entities) {
+        entity index = entity_index(sent.ent);
+        if (index >= peer.baselines.size()) {
+            peer.baselines.resize(index + 1);
+        }
+        entity_baseline &baseline = peer.baselines[index];
+        if (baseline.ent != sent.ent) {
+            // First ack for this entity (or its index was recycled)
+            baseline = entity_baseline{};
+            baseline.ent = sent.ent;
+        }
+
+        if (sent.transform_dirty != 0) {
+            ApplyTransformFields(baseline.transform, sent.transform, sent.transform_dirty);
+            baseline.has_transform = true;
+        }
+        if (sent.rigidbody_dirty != 0) {
+            ApplyRigidbodyFields(baseline.rigidbody, sent.rigidbody, sent.rigidbody_dirty);
+            baseline.has_rigidbody = true;
+        }
+        for (uint32_t i = 0; i < sent.component_count; ++i) {
+            auto const &[comp_id, hash] = snapshot.components[sent.first_component + i];
+            baseline.component_hashes[static_cast<size_t>(comp_id)] = hash;
+            baseline.component_mask |= static_cast<uint16_t>(1u << static_cast<uint32_t>(comp_id));
+        }
+    }
+    snapshot.pending = false;
+}
+
+// Old methods (kept for compatibility)
 void network_system::send_input() {
     PlayerInputPacket packet;
     packet.header.type = PacketType::PlayerInput;
@@ -4,40 +4,60 @@
 #include "components/transform.hpp"
 #include "components/network.hpp"
 #include <algorithm>
+#include <cstddef>
 #include "components/entity_state.hpp"
 
 constexpr float MAX_VELOCITY = 3000.0f;
+// Fewest bodies worth handing to another thread
+constexpr std::size_t MIN_PARALLEL_CHUNK = 256;
 
-void physics_system::update(float delta_time) {
-    for (auto entity : entities) {
-        auto& entity_state_comp = g_conductor.get_component<entity_state>(entity);
-        if (!entity_state_comp.is_active) {
-            continue;
-        }
-        
-        // Only apply physics to LOCAL entities (not remote networked entities)
-        if (g_conductor.has_component<network>(entity)) {
-            auto& network_comp = g_conductor.get_component<network>(entity);
-            if (!network_comp.is_local) {
-                continue; // Skip remote entities - their physics is simulated on the owner's machine
-            }
+namespace {
+void integrate(entity entity, transform& transform1, rigidbody& rigidbody1, const gravity& gravity1,
+               const entity_state& entity_state_comp, float delta_time) {
+    // Sleeping bodies stay put until something wakes them
+    if (!entity_state_comp.is_active || rigidbody1.is_sleeping) {
+        return;
+    }
+
+    // Only apply physics to LOCAL entities (not remote networked entities)
+    if (g_conductor.has_component<network>(entity)) {
+        auto& network_comp = g_conductor.get_component<network>(entity);
+        if (!network_comp.is_local) {
+            return; // Skip remote entities - their physics is simulated on the owner's machine
         }
-        auto& transform1 = g_conductor.get_component<transform>(entity);
-        auto& rigidbody1 = g_conductor.get_component<rigidbody>(entity);
-        auto& gravity1 = g_conductor.get_component<gravity>(entity);
+    }
 
-        rigidbody1.velocity[1] += gravity1.force * delta_time / 3;
+    rigidbody1.velocity[1] += gravity1.force * delta_time / 3;
 
-        // Clamp velocity to prevent infinite velocity
-        rigidbody1.velocity[1] = std::clamp(rigidbody1.velocity[1], -MAX_VELOCITY, MAX_VELOCITY);
-        rigidbody1.velocity[0] = std::clamp(rigidbody1.velocity[0], -MAX_VELOCITY, MAX_VELOCITY);
+    // Clamp velocity to prevent infinite velocity
+    rigidbody1.velocity[1] = std::clamp(rigidbody1.velocity[1], -MAX_VELOCITY, MAX_VELOCITY);
+    rigidbody1.velocity[0] = std::clamp(rigidbody1.velocity[0], -MAX_VELOCITY, MAX_VELOCITY);
 
-        // Save last position
-        transform1.last_position[0] = transform1.position[0];
-        transform1.last_position[1] = transform1.position[1];
+    // Save last position
+    transform1.last_position[0] = transform1.position[0];
+    transform1.last_position[1] = transform1.position[1];
 
-        // Update current position based on velocity
-        transform1.position[0] += rigidbody1.velocity[0] * delta_time;
-        transform1.position[1] += rigidbody1.velocity[1] * delta_time;
+    // Update current position based on velocity
+    transform1.position[0] += rigidbody1.velocity[0] * delta_time;
+    transform1.position[1] += rigidbody1.velocity[1] * delta_time;
+}
+} // namespace
+
+void physics_system::update(float delta_time, thread_pool *pool) {
+    auto bodies = g_conductor.view<transform, rigidbody, gravity, entity_state>();
+    if (pool == nullptr) {
+        for (auto [entity, transform1, rigidbody1, gravity1, entity_state_comp] : bodies) {
+            integrate(entity, transform1, rigidbody1, gravity1, entity_state_comp, delta_time);
+        }
+        return;
     }
-}
\ No newline at end of file
+
+    // Split the same view by position. Bodies only touch their own
+    // components, so chunks never overlap
+    pool->parallel_for(bodies.size_hint(), MIN_PARALLEL_CHUNK, [&bodies, delta_time](std::size_t begin, std::size_t end) {
+        bodies.for_each_in(begin, end, [delta_time](entity ent, transform& transform1, rigidbody& rigidbody1,
+                                                    gravity& gravity1, entity_state& entity_state_comp) {
+            integrate(ent, transform1, rigidbody1, gravity1, entity_state_comp, delta_time);
+        });
+    });
+}
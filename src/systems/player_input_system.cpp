@@ -27,16 +27,22 @@ void player_input_system::update(inventory_system &inventory_sys,
       }
     }
     // Player controls to move player rigidbody velocity, to integrate with
-    // collision detection system
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::D))
-      g_conductor.get_component<rigidbody>(entity).velocity[0] += 240.f;
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::A))
-      g_conductor.get_component<rigidbody>(entity).velocity[0] -= 240.f;
+    // collision detection system. Moving wakes a resting player
+    auto &rigidbody_comp = g_conductor.get_component<rigidbody>(entity);
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::D)) {
+      rigidbody_comp.velocity[0] += 240.f;
+      wake(rigidbody_comp);
+    }
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::A)) {
+      rigidbody_comp.velocity[0] -= 240.f;
+      wake(rigidbody_comp);
+    }
     if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Space) &&
         !g_conductor.get_component<jump>(entity).is_jumping &&
         space_was_pressed == false) {
-      g_conductor.get_component<rigidbody>(entity).velocity[1] =
+      rigidbody_comp.velocity[1] =
           g_conductor.get_component<jump>(entity).initial_velocity;
+      wake(rigidbody_comp);
       g_conductor.get_component<jump>(entity).is_jumping = true;
     }
 
@@ -0,0 +1,143 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <utility>
+
+thread_pool::thread_pool(std::size_t worker_count) {
+    m_workers.reserve(worker_count);
+    for (std::size_t i = 0; i < worker_count; ++i) {
+        m_workers.emplace_back([this]() { worker_loop(); });
+    }
+}
+
+thread_pool::~thread_pool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_task_ready.notify_all();
+    for (std::thread &worker : m_workers) {
+        worker.join();
+    }
+}
+
+void thread_pool::run_all(const std::vector<std::function<void()>> &tasks) {
+    if (tasks.empty()) {
+        return;
+    }
+    if (m_workers.empty() || tasks.size() == 1) {
+        std::exception_ptr error;
+        for (const auto &task : tasks) {
+            try {
+                task();
+            } catch (...) {
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return;
+    }
+
+    // Tasks of this batch still running or queued, and the first exception
+    // one of them threw, guarded by m_mutex
+    struct batch_state {
+        std::size_t remaining;
+        std::exception_ptr error;
+    };
+    auto batch = std::make_shared<batch_state>(batch_state{tasks.size(), nullptr});
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    // Queue all but the first task, which the calling thread runs itself.
+    // Exceptions are caught so they can't escape a worker thread
+    for (std::size_t i = 1; i < tasks.size(); ++i) {
+        m_queue.emplace_back([&task = tasks[i], batch, this]() {
+            std::exception_ptr error;
+            try {
+                task();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> done_lock(m_mutex);
+            if (error && !batch->error) {
+                batch->error = error;
+            }
+            --batch->remaining;
+        });
+    }
+    lock.unlock();
+    m_task_ready.notify_all();
+
+    // The queued tasks reference tasks, so even if this one throws the batch
+    // has to finish before returning
+    std::exception_ptr error;
+    try {
+        tasks[0]();
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    lock.lock();
+    if (error && !batch->error) {
+        batch->error = error;
+    }
+    --batch->remaining;
+    // Help with queued work (from this or any other batch) until the batch is done
+    while (batch->remaining > 0) {
+        if (!run_one(lock)) {
+            m_task_done.wait(lock);
+        }
+    }
+    if (batch->error) {
+        std::rethrow_exception(batch->error);
+    }
+}
+
+void thread_pool::parallel_for(std::size_t count, std::size_t min_chunk,
+                               const std::function<void(std::size_t, std::size_t)> &body) {
+    if (count == 0) {
+        return;
+    }
+
+    // Aim for one chunk per thread, but never below min_chunk items each
+    std::size_t threads = m_workers.size() + 1;
+    std::size_t chunk = std::max<std::size_t>(std::max<std::size_t>(min_chunk, 1),
+                                              (count + threads - 1) / threads);
+
+    std::vector<std::function<void()>> tasks;
+    for (std::size_t begin = 0; begin < count; begin += chunk) {
+        std::size_t end = std::min(count, begin + chunk);
+        tasks.emplace_back([&body, begin, end]() { body(begin, end); });
+    }
+    run_all(tasks);
+}
+
+void thread_pool::worker_loop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_task_ready.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+        if (m_queue.empty()) {
+            return; // Stopping with nothing left to do
+        }
+        run_one(lock);
+    }
+}
+
+bool thread_pool::run_one(std::unique_lock<std::mutex> &lock) {
+    if (m_queue.empty()) {
+        return false;
+    }
+    std::function<void()> task = std::move(m_queue.front());
+    m_queue.pop_front();
+
+    lock.unlock();
+    task();
+    lock.lock();
+
+    m_task_done.notify_all();
+    return true;
+}